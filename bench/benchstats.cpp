@@ -0,0 +1,284 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+
+#include "benchstats.h"
+
+// compute min, average, median, 95th percentile and max
+BENCHSERIES
+summarize (std::vector<unsigned long long> values)
+{
+	BENCHSERIES series = { values.size(), 0, 0, 0, 0, 0 };
+	if (values.empty())
+		return series;
+	std::sort (values.begin(), values.end());
+	unsigned long long sum = 0;
+	for (size_t ivalue=0; ivalue<values.size(); ivalue++)
+		sum += values[ivalue];
+	series.min = values.front();
+	series.avg = sum / values.size();
+	series.p50 = values[(values.size()-1)*50/100];
+	series.p95 = values[(values.size()-1)*95/100];
+	series.max = values.back();
+	return series;
+}
+
+// write a string with JSON escapes
+static void
+writejsonstring (FILE *output, const char *string)
+{
+	fputc ('"', output);
+	for (const char *ps=string; *ps; ps++) {
+		if (*ps=='"' || *ps=='\\')
+			fprintf (output, "\\%c", *ps);
+		else if ((unsigned char)*ps < 0x20)
+			fprintf (output, "\\u%04x", (unsigned char)*ps);
+		else
+			fputc (*ps, output);
+	}
+	fputc ('"', output);
+}
+
+static double
+ms (unsigned long long ns)
+{
+	return ns / 1000000.0;
+}
+
+static void
+writeseriesmap (FILE *output, const char *name, const std::map<std::string, std::vector<unsigned long long> > &seriesmap)
+{
+	fprintf (output, "      \"%s\": {", name);
+	const char *separator = "\n";
+	for (auto &entry : seriesmap) {
+		BENCHSERIES series = summarize (entry.second);
+		fprintf (output, "%s        ", separator);
+		writejsonstring (output, entry.first.c_str());
+		fprintf (output, ": {\"count\": %zu, \"min_ms\": %.3f, \"avg_ms\": %.3f, \"p50_ms\": %.3f, \"p95_ms\": %.3f, \"max_ms\": %.3f}",
+				series.count, ms(series.min), ms(series.avg), ms(series.p50), ms(series.p95), ms(series.max));
+		separator = ",\n";
+	}
+	fprintf (output, "%s}", seriesmap.empty()? "": "\n      ");
+}
+
+// write the results of all runs
+void
+writebenchjson (FILE *output, const char *lldbmi2path, const std::vector<BENCHRUN> &runs)
+{
+	fprintf (output, "{\n  \"lldbmi2\": ");
+	writejsonstring (output, lldbmi2path);
+	fprintf (output, ",\n  \"runs\": [");
+	for (size_t irun=0; irun<runs.size(); irun++) {
+		const BENCHRUN &run = runs[irun];
+		std::vector<unsigned long long> all;
+		for (auto &entry : run.latency)
+			all.insert (all.end(), entry.second.begin(), entry.second.end());
+		BENCHSERIES total = summarize (all);
+		fprintf (output, "%s\n    {\n      \"file\": ", irun>0? ",": "");
+		writejsonstring (output, run.name.c_str());
+		fprintf (output, ",\n      \"repeat\": %d, \"commands\": %d, \"errors\": %d, \"timeouts\": %d, \"stops\": %d,\n",
+				run.repeat, run.commands, run.errors, run.timeouts, run.stops);
+		fprintf (output, "      \"wall_ms\": %.3f, \"user_ms\": %.3f, \"system_ms\": %.3f, \"peak_rss_kb\": %ld,\n",
+				ms(run.wallns), ms(run.userns), ms(run.systemns), run.peakrsskb);
+		fprintf (output, "      \"throughput\": %.1f,\n", run.wallns>0? run.commands*1e9/run.wallns: 0.0);
+		fprintf (output, "      \"all\": {\"count\": %zu, \"min_ms\": %.3f, \"avg_ms\": %.3f, \"p50_ms\": %.3f, \"p95_ms\": %.3f, \"max_ms\": %.3f},\n",
+				total.count, ms(total.min), ms(total.avg), ms(total.p50), ms(total.p95), ms(total.max));
+		writeseriesmap (output, "latency", run.latency);
+		fprintf (output, ",\n");
+		writeseriesmap (output, "stop_latency", run.stoplatency);
+		fprintf (output, "\n    }");
+	}
+	fprintf (output, "\n  ]\n}\n");
+}
+
+const JSONVALUE *
+JSONVALUE::get (const char *name) const
+{
+	for (size_t imember=0; imember<members.size(); imember++)
+		if (members[imember].first == name)
+			return &members[imember].second;
+	return NULL;
+}
+
+double
+JSONVALUE::getnumber (const char *name) const
+{
+	const JSONVALUE *member = get (name);
+	return (member!=NULL && member->type==JSON_NUMBER)? member->number: 0;
+}
+
+static const char *
+skipspaces (const char *pj)
+{
+	while (isspace(*pj))
+		++pj;
+	return pj;
+}
+
+// parse a JSON value. return the end of the value or NULL on error
+static const char *
+parsejson (const char *pj, JSONVALUE &value)
+{
+	pj = skipspaces (pj);
+	if (*pj == '{' || *pj == '[') {
+		bool isobject = *pj == '{';
+		char closing = isobject? '}': ']';
+		value.type = isobject? JSONVALUE::JSON_OBJECT: JSONVALUE::JSON_ARRAY;
+		pj = skipspaces (pj+1);
+		if (*pj == closing)
+			return pj+1;
+		for (;;) {
+			JSONVALUE key, element;
+			if (isobject) {
+				if ((pj = parsejson (pj, key)) == NULL || key.type != JSONVALUE::JSON_STRING)
+					return NULL;
+				pj = skipspaces (pj);
+				if (*pj++ != ':')
+					return NULL;
+			}
+			if ((pj = parsejson (pj, element)) == NULL)
+				return NULL;
+			if (isobject)
+				value.members.push_back (std::make_pair (key.string, element));
+			else
+				value.elements.push_back (element);
+			pj = skipspaces (pj);
+			if (*pj == closing)
+				return pj+1;
+			if (*pj++ != ',')
+				return NULL;
+		}
+	}
+	if (*pj == '"') {
+		value.type = JSONVALUE::JSON_STRING;
+		for (++pj; *pj!='"'; pj++) {
+			if (*pj == '\0')
+				return NULL;
+			if (*pj == '\\') {
+				++pj;
+				if (*pj == 'u') {			// only \u00xx are written
+					value.string += (char)strtol (std::string(pj+1,4).c_str(), NULL, 16);
+					pj += 4;
+				}
+				else if (*pj == 'n')
+					value.string += '\n';
+				else if (*pj == 't')
+					value.string += '\t';
+				else
+					value.string += *pj;
+			}
+			else
+				value.string += *pj;
+		}
+		return pj+1;
+	}
+	if (strncmp(pj,"true",4) == 0) {
+		value.type = JSONVALUE::JSON_TRUE;
+		return pj+4;
+	}
+	if (strncmp(pj,"false",5) == 0) {
+		value.type = JSONVALUE::JSON_FALSE;
+		return pj+5;
+	}
+	if (strncmp(pj,"null",4) == 0) {
+		value.type = JSONVALUE::JSON_NULL;
+		return pj+4;
+	}
+	char *pe;
+	value.type = JSONVALUE::JSON_NUMBER;
+	value.number = strtod (pj, &pe);
+	return pe==pj? NULL: pe;
+}
+
+// read a JSON file, like the results of writebenchjson
+bool
+readjson (const char *path, JSONVALUE &value)
+{
+	FILE *input = fopen (path, "r");
+	if (input == NULL)
+		return false;
+	std::string text;
+	char buffer[8192];
+	size_t bytes;
+	while ((bytes = fread (buffer, 1, sizeof(buffer), input)) > 0)
+		text.append (buffer, bytes);
+	fclose (input);
+	const char *pj = parsejson (text.c_str(), value);
+	return pj != NULL && *skipspaces(pj) == '\0';
+}
+
+// file name without directory. runs are matched by script name
+static const char *
+filename (const char *path)
+{
+	const char *slash = strrchr (path, '/');
+	return slash!=NULL? slash+1: path;
+}
+
+// check a value against its baseline. a regression exceeds both the threshold and the slack
+static bool
+checkvalue (FILE *report, const char *run, const char *what, double value, double base, double threshold, double slack, const char *unit)
+{
+	bool regressed = base>0 && value>base*(1+threshold/100) && value-base>slack;
+	fprintf (report, "%-4s %-28s %-36s %12.3f %12.3f %+8.1f%% %s\n", regressed? "FAIL": "ok",
+			run, what, base, value, base>0? (value-base)*100/base: 0.0, unit);
+	return regressed;
+}
+
+// compare runs with the runs of a baseline results file
+// latencies p50 and p95 of all commands and of each command, stop latencies p50 and peak RSS
+// are checked. return the number of regressions, or -1 if a run has no baseline
+int
+comparebench (FILE *report, const std::vector<BENCHRUN> &runs, const JSONVALUE &baseline, double threshold, double slackms)
+{
+	int regressions = 0;
+	const JSONVALUE *baseruns = baseline.get ("runs");
+	fprintf (report, "%-4s %-28s %-36s %12s %12s %9s\n", "", "file", "measure", "baseline", "current", "change");
+	for (size_t irun=0; irun<runs.size(); irun++) {
+		const BENCHRUN &run = runs[irun];
+		const char *name = filename (run.name.c_str());
+		const JSONVALUE *base = NULL;
+		for (size_t ibase=0; baseruns!=NULL && ibase<baseruns->elements.size(); ibase++) {
+			const JSONVALUE *file = baseruns->elements[ibase].get ("file");
+			if (file!=NULL && strcmp (filename (file->string.c_str()), name) == 0)
+				base = &baseruns->elements[ibase];
+		}
+		if (base == NULL) {
+			fprintf (report, "FAIL %-28s no baseline\n", name);
+			return -1;
+		}
+		std::vector<unsigned long long> all;
+		for (auto &entry : run.latency)
+			all.insert (all.end(), entry.second.begin(), entry.second.end());
+		BENCHSERIES total = summarize (all);
+		const JSONVALUE *baseall = base->get ("all");
+		if (baseall != NULL) {
+			regressions += checkvalue (report, name, "all p50", ms(total.p50), baseall->getnumber("p50_ms"), threshold, slackms, "ms");
+			regressions += checkvalue (report, name, "all p95", ms(total.p95), baseall->getnumber("p95_ms"), threshold, slackms, "ms");
+		}
+		const JSONVALUE *baselatency = base->get ("latency");
+		for (auto &entry : run.latency) {
+			const JSONVALUE *basecommand = baselatency!=NULL? baselatency->get (entry.first.c_str()): NULL;
+			if (basecommand == NULL)
+				continue;
+			BENCHSERIES series = summarize (entry.second);
+			regressions += checkvalue (report, name, (entry.first+" p50").c_str(), ms(series.p50),
+					basecommand->getnumber("p50_ms"), threshold, slackms, "ms");
+			regressions += checkvalue (report, name, (entry.first+" p95").c_str(), ms(series.p95),
+					basecommand->getnumber("p95_ms"), threshold, slackms, "ms");
+		}
+		const JSONVALUE *basestop = base->get ("stop_latency");
+		for (auto &entry : run.stoplatency) {
+			const JSONVALUE *basecommand = basestop!=NULL? basestop->get (entry.first.c_str()): NULL;
+			if (basecommand == NULL)
+				continue;
+			BENCHSERIES series = summarize (entry.second);
+			regressions += checkvalue (report, name, (entry.first+" stop p50").c_str(), ms(series.p50),
+					basecommand->getnumber("p50_ms"), threshold, slackms, "ms");
+		}
+		regressions += checkvalue (report, name, "peak RSS", run.peakrsskb, base->getnumber("peak_rss_kb"), threshold, 0, "kB");
+	}
+	return regressions;
+}
@@ -0,0 +1,49 @@
+
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// results of the replay of one file
+typedef struct BENCHRUN {
+	std::string name;
+	int repeat = 1;
+	int commands = 0;
+	int errors = 0;
+	int timeouts = 0;
+	int stops = 0;
+	unsigned long long wallns = 0;
+	unsigned long long userns = 0;
+	unsigned long long systemns = 0;
+	long peakrsskb = 0;
+	std::map<std::string, std::vector<unsigned long long> > latency;		// result latency per command
+	std::map<std::string, std::vector<unsigned long long> > stoplatency;	// stop latency per resume command
+} BENCHRUN;
+
+// summary of a series of durations
+typedef struct {
+	size_t count;
+	unsigned long long min, avg, p50, p95, max;		// nanoseconds
+} BENCHSERIES;
+
+// JSON value read from a results file
+typedef struct JSONVALUE {
+	enum { JSON_NULL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT, JSON_TRUE, JSON_FALSE } type = JSON_NULL;
+	double number = 0;
+	std::string string;
+	std::vector<JSONVALUE> elements;
+	std::vector<std::pair<std::string, JSONVALUE> > members;
+	const JSONVALUE *get (const char *name) const;		// member or NULL
+	double getnumber (const char *name) const;			// number member or 0
+} JSONVALUE;
+
+BENCHSERIES summarize   (std::vector<unsigned long long> values);
+void writebenchjson     (FILE *output, const char *lldbmi2path, const std::vector<BENCHRUN> &runs);
+bool readjson           (const char *path, JSONVALUE &value);
+int  comparebench       (FILE *report, const std::vector<BENCHRUN> &runs, const JSONVALUE &baseline,
+						 double threshold, double slackms);
+
+#endif // BENCHSTATS_H
@@ -0,0 +1,272 @@
+
+// lldbmi2-bench
+// Replay MI scripts (tests/scripts/*.txt) and lldbmi2 logs (*.log, ">>=" lines) against lldbmi2
+// as fast as it answers, and report per-command latency, throughput and peak memory as JSON.
+// Each command waits for its result record. Commands which resume the inferior also wait
+// for the *stopped record, so no time is lost polling.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "miclient.h"
+#include "benchstats.h"
+
+#define EXIT_NO_BASELINE 77				// SKIP_RETURN_CODE of the perf tests
+
+typedef struct {
+	const char *lldbmi2path;
+	const char *projectdir;
+	const char *relocate;			// project location in replayed logs
+	const char *outputpath;			// JSON results. stdout if NULL
+	const char *lldbmi2output;		// lldbmi2 stdout and stderr
+	const char *baselinepath;		// JSON results to compare with
+	double threshold;				// percent of regression allowed
+	double slack;					// ms of regression always allowed
+	int repeat;
+	int timeout;
+	std::vector<const char *> lldbmi2args;
+} BENCHOPTIONS;
+
+static void
+help ()
+{
+	fprintf (stderr, "Usage:\n");
+	fprintf (stderr, "   lldbmi2-bench [options] file ... [-- lldbmi2 options]\n");
+	fprintf (stderr, "Arguments:\n");
+	fprintf (stderr, "   file:                 MI script (one command per line, %%s is the project location)\n");
+	fprintf (stderr, "                         or lldbmi2 log file (commands are the >>= lines).\n");
+	fprintf (stderr, "Options:\n");
+	fprintf (stderr, "   --lldbmi2 path:       lldbmi2 executable (./lldbmi2).\n");
+	fprintf (stderr, "   --project dir:        Project location, passed to lldbmi2 as PWD (current directory).\n");
+	fprintf (stderr, "   --relocate dir:       Replace dir by the project location in replayed commands.\n");
+	fprintf (stderr, "   --repeat n:           Replay each file n times (1).\n");
+	fprintf (stderr, "   --timeout ms:         Maximum wait for a record (%d).\n", MI_TIMEOUT);
+	fprintf (stderr, "   --output file_path:   Write JSON results to file (stdout).\n");
+	fprintf (stderr, "   --lldbmi2-output file_path: Write lldbmi2 stdout and stderr to file (/dev/null).\n");
+	fprintf (stderr, "   --baseline file_path: Compare with JSON results. Fail if a latency or the peak memory regressed.\n");
+	fprintf (stderr, "                         Exit with 77 if missing.\n");
+	fprintf (stderr, "   --threshold percent:  Regression allowed against the baseline (25).\n");
+	fprintf (stderr, "   --slack ms:           Latency regression always allowed against the baseline (1).\n");
+}
+
+// read the commands of a script or a log file
+static bool
+readcommands (const char *path, const BENCHOPTIONS &options, std::vector<std::string> &commands)
+{
+	FILE *fp = fopen (path, "r");
+	if (fp == NULL)
+		return false;
+	char line[LINE_MAX];
+	while (fgets (line, sizeof(line), fp) != NULL) {
+		std::string command;
+		char *pl = line, *pe;
+		if (isdigit(*pl)) {						// log file
+			if (strstr(pl,">>=") == NULL)
+				continue;
+			if ((pl = strchr (pl,'|')) == NULL)
+				continue;
+			if ((pe = strchr (++pl,'|')) == NULL)
+				continue;
+			command.assign (pl, pe-pl);
+		}
+		else {									// script file
+			while (isspace(*pl))
+				++pl;
+			if (strncmp(pl,"//",2)==0 || *pl=='\0')
+				continue;
+			if ((pe = strstr(pl,"//")) == NULL)
+				pe = pl + strlen(pl);
+			while (pe>pl && isspace(*(pe-1)))
+				--pe;
+			command.assign (pl, pe-pl);
+		}
+		size_t start = 0;						// skip the token of logged commands
+		while (start<command.size() && isdigit(command[start]))
+			++start;
+		command.erase (0, start);
+		if (command.empty())
+			continue;
+		if (options.relocate != NULL) {
+			size_t pos = 0, length = strlen(options.relocate);
+			while ((pos = command.find (options.relocate, pos)) != std::string::npos) {
+				command.replace (pos, length, options.projectdir);
+				pos += strlen(options.projectdir);
+			}
+		}
+		// the inferior output goes to lldbmi2 output, not to the tty of the recording
+		if (command.compare(0,17,"-inferior-tty-set")==0) {
+			size_t lastarg = command.find_last_of (' ');
+			if (lastarg != std::string::npos)
+				command.replace (lastarg+1, std::string::npos, "%s");
+		}
+		commands.push_back (command);
+	}
+	fclose (fp);
+	return true;
+}
+
+// name of a command, without token and arguments
+static std::string
+commandname (const std::string &command)
+{
+	size_t end = command.find_first_of (" \t");
+	return command.substr (0, end);
+}
+
+// replay commands once. return false if lldbmi2 could not be started
+static bool
+replay (const std::vector<std::string> &commands, const BENCHOPTIONS &options, BENCHRUN &run)
+{
+	MIClient client;
+	std::vector<const char *> args = options.lldbmi2args;
+	args.push_back (NULL);
+	if (!client.start (options.lldbmi2path, options.projectdir, args.data(), options.lldbmi2output))
+		return false;
+	unsigned long long start = minow();
+	for (size_t icommand=0; icommand<commands.size(); icommand++) {
+		const std::string &command = commands[icommand];
+		if (command == "-gdb-exit")
+			break;
+		MIRESPONSE response;
+		std::string name = commandname (command);
+		if (!client.execute (command.c_str(), response, options.timeout)) {
+			++run.timeouts;
+			fprintf (stderr, "lldbmi2-bench: timeout on %s\n", command.c_str());
+			if (!client.isalive())
+				break;
+			continue;
+		}
+		++run.commands;
+		run.latency[name].push_back (response.resultns);
+		if (response.stopped) {
+			++run.stops;
+			run.stoplatency[name].push_back (response.stoppedns);
+		}
+		if (strcmp(response.resultclass,"error") == 0)
+			++run.errors;
+	}
+	run.wallns += minow() - start;
+	struct rusage usage;
+	client.stop (&usage);
+	run.peakrsskb = std::max (run.peakrsskb, (long)usage.ru_maxrss);
+	run.userns += (unsigned long long)usage.ru_utime.tv_sec*1000000000ULL + usage.ru_utime.tv_usec*1000ULL;
+	run.systemns += (unsigned long long)usage.ru_stime.tv_sec*1000000000ULL + usage.ru_stime.tv_usec*1000ULL;
+	return true;
+}
+
+int
+main (int argc, char **argv)
+{
+	BENCHOPTIONS options;
+	options.lldbmi2path = "./lldbmi2";
+	options.projectdir = NULL;
+	options.relocate = NULL;
+	options.outputpath = NULL;
+	options.lldbmi2output = NULL;
+	options.baselinepath = NULL;
+	options.threshold = 25;
+	options.slack = 1;
+	options.repeat = 1;
+	options.timeout = MI_TIMEOUT;
+	std::vector<const char *> files;
+	char cwd[PATH_MAX];
+
+	for (int narg=1; narg<argc; narg++) {
+		if (strcmp (argv[narg],"--lldbmi2")==0 && narg+1<argc)
+			options.lldbmi2path = argv[++narg];
+		else if (strcmp (argv[narg],"--project")==0 && narg+1<argc)
+			options.projectdir = argv[++narg];
+		else if (strcmp (argv[narg],"--relocate")==0 && narg+1<argc)
+			options.relocate = argv[++narg];
+		else if (strcmp (argv[narg],"--repeat")==0 && narg+1<argc)
+			options.repeat = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--timeout")==0 && narg+1<argc)
+			options.timeout = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--output")==0 && narg+1<argc)
+			options.outputpath = argv[++narg];
+		else if (strcmp (argv[narg],"--lldbmi2-output")==0 && narg+1<argc)
+			options.lldbmi2output = argv[++narg];
+		else if (strcmp (argv[narg],"--baseline")==0 && narg+1<argc)
+			options.baselinepath = argv[++narg];
+		else if (strcmp (argv[narg],"--threshold")==0 && narg+1<argc)
+			options.threshold = atof (argv[++narg]);
+		else if (strcmp (argv[narg],"--slack")==0 && narg+1<argc)
+			options.slack = atof (argv[++narg]);
+		else if (strcmp (argv[narg],"--")==0) {
+			while (++narg < argc)
+				options.lldbmi2args.push_back (argv[narg]);
+		}
+		else if (*argv[narg] == '-') {
+			help ();
+			return EXIT_FAILURE;
+		}
+		else
+			files.push_back (argv[narg]);
+	}
+	if (files.empty()) {
+		help ();
+		return EXIT_FAILURE;
+	}
+	if (options.projectdir == NULL && getcwd (cwd, sizeof(cwd)) != NULL)
+		options.projectdir = cwd;
+	if (options.baselinepath != NULL && access (options.baselinepath, R_OK) != 0) {	// before replaying
+		fprintf (stderr, "lldbmi2-bench: no baseline %s. Record one with make perf-baselines\n", options.baselinepath);
+		return EXIT_NO_BASELINE;
+	}
+
+	std::vector<BENCHRUN> runs;
+	int status = EXIT_SUCCESS;
+	for (size_t ifile=0; ifile<files.size(); ifile++) {
+		std::vector<std::string> commands;
+		if (!readcommands (files[ifile], options, commands)) {
+			fprintf (stderr, "lldbmi2-bench: can not read %s\n", files[ifile]);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		BENCHRUN run;
+		run.name = files[ifile];
+		run.repeat = options.repeat;
+		for (int irepeat=0; irepeat<options.repeat; irepeat++) {
+			if (!replay (commands, options, run)) {
+				fprintf (stderr, "lldbmi2-bench: can not start %s\n", options.lldbmi2path);
+				return EXIT_FAILURE;
+			}
+		}
+		if (run.timeouts > 0)
+			status = EXIT_FAILURE;
+		runs.push_back (run);
+	}
+
+	FILE *output = stdout;
+	if (options.outputpath != NULL && (output = fopen (options.outputpath, "w")) == NULL) {
+		fprintf (stderr, "lldbmi2-bench: can not write %s\n", options.outputpath);
+		return EXIT_FAILURE;
+	}
+	writebenchjson (output, options.lldbmi2path, runs);
+	if (output != stdout)
+		fclose (output);
+
+	if (options.baselinepath != NULL) {
+		JSONVALUE baseline;
+		if (!readjson (options.baselinepath, baseline)) {
+			fprintf (stderr, "lldbmi2-bench: can not read baseline %s\n", options.baselinepath);
+			return EXIT_FAILURE;
+		}
+		// report on stderr, stdout may hold the results
+		int regressions = comparebench (stderr, runs, baseline, options.threshold, options.slack);
+		if (regressions != 0) {
+			fprintf (stderr, "lldbmi2-bench: %d regressions against %s\n", regressions, options.baselinepath);
+			status = EXIT_FAILURE;
+		}
+	}
+	return status;
+}
@@ -0,0 +1,407 @@
+
+// lldbmi2-loadgen
+// Load generator for lldbmi2. Drives a debug session like Eclipse does, through the new-ui pty
+// (see miclient.h), and generates bursts of requests: breakpoints at startup, children expansion
+// of a big structure, memory view scrolling, step storms with the views refresh after each stop
+// and watched expressions updated one by one or all at once.
+// Reports the latency distribution and the throughput of each burst as JSON.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "miclient.h"
+#include "benchstats.h"
+
+#define EXPAND_MAX 10000		// maximum varobjs created by the expansion burst
+
+typedef struct {
+	const char *lldbmi2path;
+	const char *projectdir;
+	const char *program;			// debugged program, relative to the project location
+	const char *args;				// arguments of the debugged program
+	const char *location;			// where bursts start, relative to the project location
+	const char *expression;			// structure to expand and to view in memory
+	const char *outputpath;			// JSON results. stdout if NULL
+	const char *lldbmi2output;		// lldbmi2 stdout and stderr
+	int breakpoints;
+	int depth;
+	int pages;
+	int pagesize;
+	int steps;
+	int watches;
+	int watchsteps;
+	int timeout;
+	std::vector<const char *> lldbmi2args;
+} LOADOPTIONS;
+
+// what Eclipse sends before loading the program
+static const char *startcommands[] = {
+	"-list-features", "-gdb-version", "-gdb-set breakpoint pending on", "-gdb-set detach-on-fork on",
+	"-enable-pretty-printing", "-gdb-set python print-stack none", "-gdb-set print object on",
+	"-gdb-set print sevenbit-strings on", "-gdb-set host-charset UTF-8", "-gdb-set target-charset UTF-8",
+	"-gdb-set target-wide-charset UTF-32", "-gdb-set dprintf-style call", "-gdb-set target-async off",
+	"-gdb-set auto-solib-add on", NULL
+};
+
+// what Eclipse sends to refresh its views after a stop
+static const char *refreshcommands[] = {
+	"-list-thread-groups i1", "-thread-info", "-stack-info-depth --thread 1 11", "-stack-list-frames --thread 1",
+	"-stack-list-locals --thread 1 --frame 0 1", "-var-update 1 *", NULL
+};
+
+static void
+help ()
+{
+	fprintf (stderr, "Usage:\n");
+	fprintf (stderr, "   lldbmi2-loadgen [options] [-- lldbmi2 options]\n");
+	fprintf (stderr, "Options:\n");
+	fprintf (stderr, "   --lldbmi2 path:       lldbmi2 executable (./lldbmi2).\n");
+	fprintf (stderr, "   --project dir:        Project location, passed to lldbmi2 as PWD (current directory).\n");
+	fprintf (stderr, "   --program path:       Debugged program, relative to the project (build/tests).\n");
+	fprintf (stderr, "   --args args:          Arguments of the debugged program (15).\n");
+	fprintf (stderr, "   --location file:line: Stop where the bursts start (tests/src/tests.cpp:350).\n");
+	fprintf (stderr, "   --expression expr:    Structure to expand and to view in memory (bg).\n");
+	fprintf (stderr, "   --breakpoints n:      Disabled breakpoints inserted at startup (200).\n");
+	fprintf (stderr, "   --depth n:            Levels of children expanded (3).\n");
+	fprintf (stderr, "   --pages n:            Memory pages scrolled (64).\n");
+	fprintf (stderr, "   --page-size bytes:    Size of a memory page (320).\n");
+	fprintf (stderr, "   --steps n:            Instruction steps of the step storm (100).\n");
+	fprintf (stderr, "   --watches n:          Watched expressions on the members of the structure (200).\n");
+	fprintf (stderr, "   --watch-steps n:      Steps updating the watched expressions, one by one then all at once (10).\n");
+	fprintf (stderr, "   --timeout ms:         Maximum wait for a record (%d).\n", MI_TIMEOUT);
+	fprintf (stderr, "   --output file_path:   Write JSON results to file (stdout).\n");
+	fprintf (stderr, "   --lldbmi2-output file_path: Write lldbmi2 stdout and stderr to file (/dev/null).\n");
+}
+
+// name of a command, without arguments
+static std::string
+commandname (const char *command)
+{
+	return std::string (command, strcspn (command, " \t"));
+}
+
+// execute a command and record its latency in the burst and in the session
+static bool
+request (MIClient &client, const char *command, const LOADOPTIONS &options, BENCHRUN &burst, BENCHRUN &session, MIRESPONSE &response)
+{
+	if (!client.execute (command, response, options.timeout)) {
+		++burst.timeouts;
+		++session.timeouts;
+		fprintf (stderr, "lldbmi2-loadgen: timeout on %s\n", command);
+		return false;
+	}
+	std::string name = commandname (command);
+	BENCHRUN *runs[] = { &burst, &session };
+	for (int irun=0; irun<2; irun++) {
+		BENCHRUN &run = *runs[irun];
+		++run.commands;
+		run.latency[name].push_back (response.resultns);
+		if (response.stopped) {
+			++run.stops;
+			run.stoplatency[name].push_back (response.stoppedns);
+		}
+		if (strcmp(response.resultclass,"error") == 0)
+			++run.errors;
+	}
+	return true;
+}
+
+// start a burst
+static void
+beginburst (BENCHRUN &burst, const char *name)
+{
+	burst.name = name;
+	burst.repeat = 1;
+	burst.wallns = minow();
+}
+
+// end a burst and keep it in the results
+static void
+endburst (BENCHRUN &burst, std::vector<BENCHRUN> &runs)
+{
+	burst.wallns = minow() - burst.wallns;
+	runs.push_back (burst);
+}
+
+// get the names and the number of children of a -var-list-children result
+// ^done,numchild="2",children=[child={name="var1.a",exp="a",numchild="0",...},...]
+static void
+scanchildren (const std::string &result, std::vector<std::pair<std::string,int> > &children)
+{
+	size_t pos = 0;
+	while ((pos = result.find ("child={name=\"", pos)) != std::string::npos) {
+		pos += 13;
+		size_t end = result.find ('"', pos);
+		if (end == std::string::npos)
+			return;
+		std::string name = result.substr (pos, end-pos);
+		size_t numchild = result.find ("numchild=\"", end);
+		if (numchild == std::string::npos)
+			return;
+		children.push_back (std::make_pair (name, atoi (result.c_str()+numchild+10)));
+		pos = numchild;
+	}
+}
+
+// get the expressions of the children of a -var-list-children result
+static void
+scanexpressions (const std::string &result, std::vector<std::string> &expressions)
+{
+	size_t pos = 0;
+	while ((pos = result.find (",exp=\"", pos)) != std::string::npos) {
+		pos += 6;
+		size_t end = result.find ('"', pos);
+		if (end == std::string::npos)
+			return;
+		expressions.push_back (result.substr (pos, end-pos));
+		pos = end;
+	}
+}
+
+// run a session. return false if lldbmi2 could not be started
+static bool
+loadsession (const LOADOPTIONS &options, std::vector<BENCHRUN> &runs)
+{
+	MIClient client;
+	std::vector<const char *> args = options.lldbmi2args;
+	args.push_back (NULL);
+	if (!client.start (options.lldbmi2path, options.projectdir, args.data(), options.lldbmi2output))
+		return false;
+	BENCHRUN session, burst;
+	MIRESPONSE response;
+	std::string command;
+	char line[PATH_MAX+NAME_MAX];
+	session.name = "session";
+	session.repeat = 1;
+	unsigned long long start = minow();
+
+	// startup
+	beginburst (burst, "startup");
+	for (int icommand=0; startcommands[icommand]!=NULL; icommand++)
+		request (client, startcommands[icommand], options, burst, session, response);
+	snprintf (line, sizeof(line), "-environment-cd %s", options.projectdir);
+	request (client, line, options, burst, session, response);
+	snprintf (line, sizeof(line), "-file-exec-and-symbols --thread-group i1 %s/%s", options.projectdir, options.program);
+	request (client, line, options, burst, session, response);
+	request (client, "-list-thread-groups", options, burst, session, response);
+	command = std::string("-gdb-set --thread-group i1 args ") + options.args;
+	request (client, command.c_str(), options, burst, session, response);
+	endburst (burst, runs);
+
+	// breakpoints. disabled, at every line of the source of the location
+	burst = BENCHRUN();
+	beginburst (burst, "breakpoints");
+	std::string source (options.location, strcspn (options.location, ":"));
+	for (int ibreakpoint=0; ibreakpoint<options.breakpoints; ibreakpoint++) {
+		snprintf (line, sizeof(line), "-break-insert -d -f %s/%s:%d", options.projectdir, source.c_str(), ibreakpoint%400+1);
+		request (client, line, options, burst, session, response);
+	}
+	snprintf (line, sizeof(line), "-break-insert -f %s/%s", options.projectdir, options.location);
+	request (client, line, options, burst, session, response);
+	endburst (burst, runs);
+
+	// run to the location and refresh the views
+	burst = BENCHRUN();
+	beginburst (burst, "run");
+	request (client, "-exec-run --thread-group i1", options, burst, session, response);
+	for (int icommand=0; refreshcommands[icommand]!=NULL; icommand++)
+		request (client, refreshcommands[icommand], options, burst, session, response);
+	endburst (burst, runs);
+
+	// expand all children of the expression, level after level
+	burst = BENCHRUN();
+	beginburst (burst, "expand");
+	command = std::string("-var-create --thread 1 --frame 0 - * ") + options.expression;
+	std::vector<std::string> members;
+	if (request (client, command.c_str(), options, burst, session, response)) {
+		std::vector<std::pair<std::string,int> > level, nextlevel;
+		size_t namepos = response.result.find ("name=\"");
+		if (namepos != std::string::npos) {
+			namepos += 6;
+			level.push_back (std::make_pair (response.result.substr (namepos, response.result.find ('"',namepos)-namepos), 1));
+		}
+		int varobjs = 1;
+		for (int idepth=0; idepth<options.depth && !level.empty() && varobjs<EXPAND_MAX; idepth++) {
+			nextlevel.clear();
+			for (size_t ivar=0; ivar<level.size() && varobjs<EXPAND_MAX; ivar++) {
+				if (level[ivar].second <= 0)
+					continue;
+				command = "-var-list-children " + level[ivar].first;
+				if (!request (client, command.c_str(), options, burst, session, response))
+					continue;
+				size_t children = nextlevel.size();
+				scanchildren (response.result, nextlevel);
+				if (idepth == 0)
+					scanexpressions (response.result, members);
+				varobjs += nextlevel.size() - children;
+			}
+			level.swap (nextlevel);
+		}
+	}
+	endburst (burst, runs);
+
+	// scroll a memory view from the address of the expression
+	burst = BENCHRUN();
+	beginburst (burst, "memory");
+	command = std::string("-data-evaluate-expression --thread 1 --frame 0 &") + options.expression;
+	unsigned long long address = 0;
+	if (request (client, command.c_str(), options, burst, session, response)) {
+		size_t valuepos = response.result.find ("0x");
+		if (valuepos != std::string::npos)
+			address = strtoull (response.result.c_str()+valuepos, NULL, 16);
+	}
+	for (int ipage=0; address!=0 && ipage<options.pages; ipage++) {
+		snprintf (line, sizeof(line), "-data-read-memory-bytes %llu %d", address+(unsigned long long)ipage*options.pagesize, options.pagesize);
+		request (client, line, options, burst, session, response);
+	}
+	endburst (burst, runs);
+
+	// watched expressions on the members of the structure
+	burst = BENCHRUN();
+	beginburst (burst, "watch-create");
+	std::vector<std::string> watches;
+	for (int iwatch=0; iwatch<options.watches && !members.empty(); iwatch++) {
+		command = std::string("-var-create --thread 1 --frame 0 - * ") + options.expression + "." + members[iwatch%members.size()];
+		if (!request (client, command.c_str(), options, burst, session, response))
+			continue;
+		size_t namepos = response.result.find ("name=\"");
+		if (strcmp(response.resultclass,"done")==0 && namepos!=std::string::npos) {
+			namepos += 6;
+			watches.push_back (response.result.substr (namepos, response.result.find ('"',namepos)-namepos));
+		}
+	}
+	endburst (burst, runs);
+
+	// update the watched expressions after each step: one command per varobj, then one for all
+	for (int iupdate=0; iupdate<2; iupdate++) {
+		burst = BENCHRUN();
+		beginburst (burst, iupdate==0? "watch-each": "watch-all");
+		for (int istep=0; istep<options.watchsteps && !watches.empty(); istep++) {
+			if (!request (client, "-exec-step-instruction --thread 1", options, burst, session, response))
+				break;
+			if (strcmp(response.resultclass,"running") != 0)		// program exited
+				break;
+			if (iupdate == 1)
+				request (client, "-var-update 1 *", options, burst, session, response);
+			else
+				for (size_t iwatch=0; iwatch<watches.size(); iwatch++) {
+					command = "-var-update 1 " + watches[iwatch];
+					request (client, command.c_str(), options, burst, session, response);
+				}
+		}
+		endburst (burst, runs);
+	}
+
+	// step storm. each stop refreshes the views
+	burst = BENCHRUN();
+	beginburst (burst, "steps");
+	for (int istep=0; istep<options.steps; istep++) {
+		if (!request (client, "-exec-step-instruction --thread 1", options, burst, session, response))
+			break;
+		if (strcmp(response.resultclass,"running") != 0)			// program exited
+			break;
+		for (int icommand=0; refreshcommands[icommand]!=NULL; icommand++)
+			request (client, refreshcommands[icommand], options, burst, session, response);
+	}
+	endburst (burst, runs);
+
+	session.wallns = minow() - start;
+	struct rusage usage;
+	client.stop (&usage);
+	session.peakrsskb = usage.ru_maxrss;
+	session.userns = (unsigned long long)usage.ru_utime.tv_sec*1000000000ULL + usage.ru_utime.tv_usec*1000ULL;
+	session.systemns = (unsigned long long)usage.ru_stime.tv_sec*1000000000ULL + usage.ru_stime.tv_usec*1000ULL;
+	runs.push_back (session);
+	return true;
+}
+
+int
+main (int argc, char **argv)
+{
+	LOADOPTIONS options;
+	options.lldbmi2path = "./lldbmi2";
+	options.projectdir = NULL;
+	options.program = "build/tests";
+	options.args = "15";
+	options.location = "tests/src/tests.cpp:350";
+	options.expression = "bg";
+	options.outputpath = NULL;
+	options.lldbmi2output = NULL;
+	options.breakpoints = 200;
+	options.depth = 3;
+	options.pages = 64;
+	options.pagesize = 320;
+	options.steps = 100;
+	options.watches = 200;
+	options.watchsteps = 10;
+	options.timeout = MI_TIMEOUT;
+	char cwd[PATH_MAX];
+
+	for (int narg=1; narg<argc; narg++) {
+		if (strcmp (argv[narg],"--lldbmi2")==0 && narg+1<argc)
+			options.lldbmi2path = argv[++narg];
+		else if (strcmp (argv[narg],"--project")==0 && narg+1<argc)
+			options.projectdir = argv[++narg];
+		else if (strcmp (argv[narg],"--program")==0 && narg+1<argc)
+			options.program = argv[++narg];
+		else if (strcmp (argv[narg],"--args")==0 && narg+1<argc)
+			options.args = argv[++narg];
+		else if (strcmp (argv[narg],"--location")==0 && narg+1<argc)
+			options.location = argv[++narg];
+		else if (strcmp (argv[narg],"--expression")==0 && narg+1<argc)
+			options.expression = argv[++narg];
+		else if (strcmp (argv[narg],"--breakpoints")==0 && narg+1<argc)
+			options.breakpoints = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--depth")==0 && narg+1<argc)
+			options.depth = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--pages")==0 && narg+1<argc)
+			options.pages = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--page-size")==0 && narg+1<argc)
+			options.pagesize = std::max (1, atoi (argv[++narg]));
+		else if (strcmp (argv[narg],"--steps")==0 && narg+1<argc)
+			options.steps = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--watches")==0 && narg+1<argc)
+			options.watches = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--watch-steps")==0 && narg+1<argc)
+			options.watchsteps = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--timeout")==0 && narg+1<argc)
+			options.timeout = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--output")==0 && narg+1<argc)
+			options.outputpath = argv[++narg];
+		else if (strcmp (argv[narg],"--lldbmi2-output")==0 && narg+1<argc)
+			options.lldbmi2output = argv[++narg];
+		else if (strcmp (argv[narg],"--")==0) {
+			while (++narg < argc)
+				options.lldbmi2args.push_back (argv[narg]);
+		}
+		else {
+			help ();
+			return EXIT_FAILURE;
+		}
+	}
+	if (options.projectdir == NULL && getcwd (cwd, sizeof(cwd)) != NULL)
+		options.projectdir = cwd;
+
+	std::vector<BENCHRUN> runs;
+	if (!loadsession (options, runs)) {
+		fprintf (stderr, "lldbmi2-loadgen: can not start %s\n", options.lldbmi2path);
+		return EXIT_FAILURE;
+	}
+
+	FILE *output = stdout;
+	if (options.outputpath != NULL && (output = fopen (options.outputpath, "w")) == NULL) {
+		fprintf (stderr, "lldbmi2-loadgen: can not write %s\n", options.outputpath);
+		return EXIT_FAILURE;
+	}
+	writebenchjson (output, options.lldbmi2path, runs);
+	if (output != stdout)
+		fclose (output);
+	return runs.back().timeouts>0? EXIT_FAILURE: EXIT_SUCCESS;
+}
@@ -0,0 +1,288 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/wait.h>
+#include <vector>
+
+#include "miclient.h"
+
+static const char *resumecommands[] = {
+	"-exec-run", "-exec-continue", "-exec-step", "-exec-next", "-exec-step-instruction",
+	"-exec-next-instruction", "-exec-finish", "-exec-until", NULL
+};
+
+
+// return monotonic time in nanoseconds
+unsigned long long
+minow ()
+{
+	timespec tp;
+	clock_gettime (CLOCK_MONOTONIC, &tp);
+	return (unsigned long long)tp.tv_sec*1000000000ULL + tp.tv_nsec;
+}
+
+// check if a command resumes the inferior. command may start with a token
+bool
+isresumecommand (const char *command)
+{
+	while (isdigit(*command))
+		++command;
+	for (int icommand=0; resumecommands[icommand]!=NULL; icommand++) {
+		size_t length = strlen(resumecommands[icommand]);
+		if (strncmp(command,resumecommands[icommand],length)==0 && (command[length]=='\0' || isspace(command[length])))
+			return true;
+	}
+	return false;
+}
+
+
+MIClient::MIClient () {
+	masterfd = slavefd = stdinfd = -1;
+	pid = -1;
+	nexttoken = 1;
+	stopseen = false;
+	eof = false;
+}
+
+MIClient::~MIClient () {
+	if (pid > 0)
+		stop (NULL);
+}
+
+// start lldbmi2 on a new pty. output is lldbmi2 stdout and stderr. /dev/null if NULL
+// return when lldbmi2 has written its first prompt
+bool
+MIClient::start (const char *lldbmi2path, const char *projectdir, const char *const *extraargs, const char *outputpath)
+{
+	masterfd = posix_openpt (O_RDWR|O_NOCTTY);
+	if (masterfd<0 || grantpt(masterfd)<0 || unlockpt(masterfd)<0)
+		return false;
+	char ptyname[64];
+	if (ptsname_r (masterfd, ptyname, sizeof(ptyname)) != 0)
+		return false;
+	// keep the slave open so reads on master do not fail before lldbmi2 opens it
+	slavefd = open (ptyname, O_RDWR|O_NOCTTY);
+	struct termios t;
+	if (slavefd>=0 && tcgetattr(slavefd, &t)==0) {
+		cfmakeraw (&t);
+		tcsetattr (slavefd, TCSANOW, &t);
+	}
+	int stdinpipe[2];
+	if (pipe(stdinpipe) < 0)
+		return false;
+	char newui[NAME_MAX];
+	snprintf (newui, sizeof(newui), "new-ui mi %s", ptyname);
+	std::vector<const char *> argv;
+	argv.push_back (lldbmi2path);
+	argv.push_back ("--interpreter");
+	argv.push_back ("mi2");
+	argv.push_back ("-ex");
+	argv.push_back (newui);
+	for (int iarg=0; extraargs!=NULL && extraargs[iarg]!=NULL; iarg++)
+		argv.push_back (extraargs[iarg]);
+	argv.push_back (NULL);
+
+	pid = fork ();
+	if (pid < 0)
+		return false;
+	if (pid == 0) {
+		// lldbmi2 takes the project location (%s in commands) from PWD
+		if (projectdir != NULL) {
+			if (chdir (projectdir) == 0)
+				setenv ("PWD", projectdir, 1);
+		}
+		dup2 (stdinpipe[0], STDIN_FILENO);
+		int outputfd = open (outputpath!=NULL? outputpath: "/dev/null", O_WRONLY|O_CREAT|O_APPEND, 0644);
+		if (outputfd >= 0) {
+			dup2 (outputfd, STDOUT_FILENO);
+			dup2 (outputfd, STDERR_FILENO);
+			close (outputfd);
+		}
+		close (stdinpipe[0]);
+		close (stdinpipe[1]);
+		close (masterfd);
+		if (slavefd >= 0)
+			close (slavefd);
+		execv (lldbmi2path, (char *const *)argv.data());
+		_exit (127);
+	}
+	close (stdinpipe[0]);
+	stdinfd = stdinpipe[1];
+	fcntl (stdinfd, F_SETFD, FD_CLOEXEC);
+	fcntl (masterfd, F_SETFD, FD_CLOEXEC);
+	// wait first prompt. lldbmi2 waits 2 seconds before printing it
+	std::string record;
+	while (readrecord (record, MI_TIMEOUT))
+		if (record == "(gdb)")
+			return true;
+	return false;
+}
+
+// send a command with a new token. return the token
+int
+MIClient::send (const char *command)
+{
+	while (isdigit(*command))			// replace the token of replayed commands
+		++command;
+	int token = nexttoken++;
+	char line[16];
+	snprintf (line, sizeof(line), "%d", token);
+	std::string commandline = line;
+	commandline += command;
+	commandline += "\n";
+	stopseen = false;
+	if (write (masterfd, commandline.c_str(), commandline.size()) != (ssize_t)commandline.size())
+		return -1;
+	return token;
+}
+
+// read a record. return false on timeout or end of file
+bool
+MIClient::readrecord (std::string &record, int timeoutms)
+{
+	unsigned long long deadline = minow() + (unsigned long long)timeoutms*1000000;
+	for (;;) {
+		size_t endofline = input.find ('\n');
+		if (endofline != std::string::npos) {
+			record.assign (input, 0, endofline);
+			input.erase (0, endofline+1);
+			if (record.size()>0 && record[record.size()-1]=='\r')
+				record.erase (record.size()-1);
+			if (record.compare(0,8,"*stopped")==0 || record.compare(0,20,"=thread-group-exited")==0)
+				stopseen = true;
+			return true;
+		}
+		if (eof)
+			return false;
+		unsigned long long now = minow();
+		if (now >= deadline)
+			return false;
+		struct pollfd pfd = { masterfd, POLLIN, 0 };
+		int ready = poll (&pfd, 1, (int)((deadline-now)/1000000)+1);
+		if (ready < 0)
+			return false;
+		if (ready == 0)
+			continue;
+		char buffer[8192];
+		ssize_t bytes = read (masterfd, buffer, sizeof(buffer));
+		if (bytes <= 0) {
+			eof = true;
+			continue;
+		}
+		input.append (buffer, bytes);
+	}
+}
+
+// wait a stop record
+bool
+MIClient::waitstopped (int timeoutms)
+{
+	std::string record;
+	while (!stopseen)
+		if (!readrecord (record, timeoutms))
+			return false;
+	return true;
+}
+
+// send a command and wait its result record. if the inferior runs, wait it stops
+bool
+MIClient::execute (const char *command, MIRESPONSE &response, int timeoutms)
+{
+	response.resultclass[0] = '\0';
+	response.result.clear();
+	response.stopped = false;
+	response.resultns = response.stoppedns = 0;
+	response.records = 0;
+	unsigned long long start = minow();
+	int token = send (command);
+	if (token < 0)
+		return false;
+	char prefix[16];
+	int prefixsize = snprintf (prefix, sizeof(prefix), "%d^", token);
+	std::string record;
+	for (;;) {
+		if (!readrecord (record, timeoutms))
+			return false;
+		++response.records;
+		if (record.compare(0,prefixsize,prefix) == 0)
+			break;
+	}
+	response.resultns = minow() - start;
+	response.result = record;
+	size_t classsize = strcspn (record.c_str()+prefixsize, ",");
+	if (classsize >= sizeof(response.resultclass))
+		classsize = sizeof(response.resultclass)-1;
+	strncpy (response.resultclass, record.c_str()+prefixsize, classsize);
+	response.resultclass[classsize] = '\0';
+	if (strcmp(response.resultclass,"running") == 0) {
+		while (!stopseen) {
+			if (!readrecord (record, timeoutms))
+				return false;
+			++response.records;
+		}
+		response.stopped = true;
+		response.stoppedns = minow() - start;
+	}
+	return true;
+}
+
+// check if lldbmi2 is running. do not reap it, stop needs its resources usage
+bool
+MIClient::isalive ()
+{
+	if (pid <= 0)
+		return false;
+	siginfo_t info;
+	info.si_pid = 0;
+	if (waitid (P_PID, pid, &info, WEXITED|WNOHANG|WNOWAIT) < 0)
+		return false;
+	return info.si_pid == 0;
+}
+
+pid_t
+MIClient::getpid ()
+{
+	return pid;
+}
+
+// terminate lldbmi2 and return its exit status. usage receives its resources usage
+int
+MIClient::stop (struct rusage *usage)
+{
+	int status = -1;
+	if (pid > 0) {
+		if (isalive()) {
+			std::string record;
+			send ("-gdb-exit");
+			close (stdinfd);				// lldbmi2 exits on stdin end of file
+			stdinfd = -1;
+			unsigned long long deadline = minow() + 5000000000ULL;
+			while (isalive() && minow()<deadline)
+				if (!readrecord (record, 100))
+					usleep (10000);
+			if (isalive())
+				kill (pid, SIGKILL);
+		}
+		struct rusage localusage;
+		if (wait4 (pid, &status, 0, usage!=NULL? usage: &localusage) < 0)
+			status = -1;
+		pid = -1;
+	}
+	if (stdinfd >= 0)
+		close (stdinfd);
+	if (slavefd >= 0)
+		close (slavefd);
+	if (masterfd >= 0)
+		close (masterfd);
+	masterfd = slavefd = stdinfd = -1;
+	return status;
+}
@@ -0,0 +1,54 @@
+
+#ifndef MICLIENT_H
+#define MICLIENT_H
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <string>
+
+/*
+ * MIClient class
+ * Drives lldbmi2 like an IDE does: MI commands and records go through a pty
+ * given with -ex "new-ui mi /dev/pts/N", and stdin is kept open on a pipe
+ * (lldbmi2 exits on stdin EOF).
+ */
+
+#define MI_TIMEOUT 30000		// default timeout in milliseconds
+
+// response to a command
+typedef struct {
+	char resultclass[16];				// done, running, error, exit. empty if timeout
+	std::string result;					// result record
+	bool stopped;						// *stopped or =thread-group-exited received
+	unsigned long long resultns;		// from send to result record
+	unsigned long long stoppedns;		// from send to stop record. 0 if not resumed
+	int records;						// records received until the response was complete
+} MIRESPONSE;
+
+class MIClient {
+private:
+	int masterfd;
+	int slavefd;
+	int stdinfd;
+	pid_t pid;
+	int nexttoken;
+	std::string input;					// partial record
+	bool stopseen;						// stop record since last send
+	bool eof;
+public:
+	MIClient ();
+	virtual ~MIClient ();
+	bool start (const char *lldbmi2path, const char *projectdir, const char *const *extraargs, const char *outputpath=NULL);
+	int  send (const char *command);
+	bool readrecord (std::string &record, int timeoutms);
+	bool execute (const char *command, MIRESPONSE &response, int timeoutms=MI_TIMEOUT);
+	bool waitstopped (int timeoutms);
+	int  stop (struct rusage *usage);
+	bool isalive ();
+	pid_t getpid ();
+};
+
+unsigned long long minow ();		// monotonic time in nanoseconds
+bool isresumecommand (const char *command);
+
+#endif // MICLIENT_H
@@ -0,0 +1,276 @@
+
+// lldbmi2-microbench
+// Measure the formatting layer (src/format.cpp) on the synthetic model of bench/synthetic.cpp:
+// 1M elements arrays, 50 levels of inheritance and 10k threads processes, and the CPU helpers
+// (StringB, scanArgs, strfind, logdata, record formatting) on inputs taken from tests/scripts.
+// No LLDB nor inferior is required, so results are reproducible and the whole run takes a few
+// seconds. Results are JSON, tagged with the lldbmi2 version, to be tracked per commit.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "format.h"
+#include "command.h"
+#include "log.h"
+#include "strlxxx.h"
+#include "version.h"
+#include "synthetic.h"
+#include "benchstats.h"
+
+LIMITS limits;
+
+typedef struct {
+	const char *name;
+	std::function<void()> run;
+} MICROBENCH;
+
+// commands sent by Eclipse. tests/scripts/largearray.log
+static const char *commandsamples[] = {
+	"1-list-features",
+	"3-environment-cd /home/didier/projets/c/lldbmi2",
+	"17-file-exec-and-symbols --thread-group i1 /home/didier/projets/c/lldbmi2/build/tests",
+	"22-interpreter-exec --thread-group i1 console \"p/x (char)-1\"",
+	"23-data-evaluate-expression --thread-group i1 \"sizeof (void*)\"",
+	"26-break-insert -f /home/didier/projets/c/lldbmi2/src/variables.cpp:447",
+	"32-inferior-tty-set --thread-group i1 /dev/ttyp0",
+	"33-exec-run --thread-group i1",
+	"38-stack-info-depth --thread 1 11",
+	"40-var-create --thread-group i1 - * ccc+0",
+	"56-var-create --thread 1 --frame 0 - * *((ccc)+0)@100",
+	"58-var-create --thread 1 --frame 0 - * &(*((ccc)+0)@100)",
+	"60-data-evaluate-expression --thread 1 --frame 0 *((ccc)+0)@100",
+	"61-var-set-format $7 octal",
+	"69-interpreter-exec --thread-group i1 console kill",
+	NULL
+};
+
+// records sent to Eclipse. tests/scripts/largearray.log
+static const char *stoppedsample =
+	"*stopped,reason=\"breakpoint-hit\",disp=\"keep\",bkptno=\"5\",frame={addr=\"0x0000000000001434\","
+	"func=\"test_LARGE_CHAR_ARRAY()\",args=[],file=\"tests.cpp\",fullname=\"/home/didier/projets/c/lldbmi2/tests/src/tests.cpp\","
+	"line=\"92\"},thread-id=\"1\",stopped-threads=\"all\"\n(gdb)\n";
+static const char *threadsample =
+	"{id=\"1\",target-id=\"Thread 0x165a0 of process 8196\",frame={level=\"0\",addr=\"0x0000000000001434\","
+	"func=\"test_LARGE_CHAR_ARRAY()\",args=[],file=\"tests.cpp\",fullname=\"/home/didier/projets/c/lldbmi2/tests/src/tests.cpp\","
+	"line=\"92\"},state=\"stopped\"}";
+
+// expression paths returned by LLDB which need fixups
+static const char *pathsamples[] = {
+	"ccc",
+	"this->b.c.[2]",
+	"cdp->[1].d",
+	"u..inner.[0]..x.",
+	"table->[3].[2]..inner.[0]->[1].values.[7].name.",
+	NULL
+};
+
+// display type of a deep template instance
+static const char *typesample =
+	"std::__1::vector<std::__1::map<std::__1::basic_string<char, std::__1::char_traits<char>, "
+	"std::__1::allocator<char> >, Struct, std::__1::less<std::__1::basic_string<char> >, "
+	"std::__1::allocator<std::__1::pair<const std::__1::basic_string<char>, Struct> > >, "
+	"std::__1::allocator<std::__1::map<std::__1::basic_string<char>, Struct> > >::value_type";
+
+// format a record like cdtprintf
+static char *
+record (StringB &recordB, const char *format, ...)
+{
+	va_list args;
+	va_start (args, format);
+	formatRecord (recordB, format, args);
+	va_end (args);
+	return recordB.c_str();
+}
+
+static unsigned long long
+nowns ()
+{
+	timespec tp;
+	clock_gettime (CLOCK_MONOTONIC, &tp);
+	return (unsigned long long)tp.tv_sec*1000000000ULL + tp.tv_nsec;
+}
+
+static void
+help ()
+{
+	fprintf (stderr, "Usage:\n");
+	fprintf (stderr, "   lldbmi2-microbench [options] [benchmark ...]\n");
+	fprintf (stderr, "Options:\n");
+	fprintf (stderr, "   --iterations n:       Iterations of each benchmark (100).\n");
+	fprintf (stderr, "   --children n:         Max number of children to format (%d).\n", CHILDREN_MAX);
+	fprintf (stderr, "   --output file_path:   Write JSON results to file (stdout).\n");
+	fprintf (stderr, "   --list:               List benchmarks.\n");
+}
+
+int
+main (int argc, char **argv)
+{
+	int iterations = 100;
+	const char *outputpath = NULL;
+	bool list = false;
+	std::vector<const char *> selected;
+	limits.istest = false;
+	limits.frames_max = 0;
+	limits.children_max = CHILDREN_MAX;
+	limits.walk_depth_max = WALK_DEPTH_MAX;
+	limits.change_depth_max = CHANGE_DEPTH_MAX;
+	setlogmask (LOG_NONE);
+	openlogfile ("/dev/null");			// logdata only formats when a log is open
+
+	for (int narg=1; narg<argc; narg++) {
+		if (strcmp (argv[narg],"--iterations")==0 && narg+1<argc)
+			iterations = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--children")==0 && narg+1<argc)
+			limits.children_max = atoi (argv[++narg]);
+		else if (strcmp (argv[narg],"--output")==0 && narg+1<argc)
+			outputpath = argv[++narg];
+		else if (strcmp (argv[narg],"--list")==0)
+			list = true;
+		else if (*argv[narg] == '-') {
+			help ();
+			return EXIT_FAILURE;
+		}
+		else
+			selected.push_back (argv[narg]);
+	}
+
+	static StringB descB(BIG_LINE_MAX);
+	SyntheticValue scalar (SYNTHETIC_INT, "count", "count", 42);
+	SyntheticValue string (SYNTHETIC_STRING, "name", "name", 0);
+	SyntheticValue array (SYNTHETIC_ARRAY, "table", "table", 1000000);
+	SyntheticValue derived (SYNTHETIC_DERIVED, "object", "object", 50);
+	SyntheticValueList locals;
+	for (int ilocal=0; ilocal<20; ilocal++) {
+		char localname[16];
+		snprintf (localname, sizeof(localname), "local%d", ilocal);
+		locals.add (SyntheticValue ((SyntheticKind)(ilocal%4), localname, localname, ilocal%4==SYNTHETIC_ARRAY? 100: ilocal));
+	}
+	SyntheticFrame frame (0);
+	SyntheticProcess process (10000, 20);
+	char arrayexpression[] = "table", derivedexpression[] = "object";
+	int numchildren;
+	bool separatorvisible;
+
+	std::vector<MICROBENCH> benchmarks = {
+		{ "formatValue/int", [&]() { formatValue (descB, scalar, FULL_SUMMARY); } },
+		{ "formatValue/string", [&]() { formatValue (descB, string, FULL_SUMMARY); } },
+		{ "formatValue/array-1M", [&]() { formatValue (descB, array, FULL_SUMMARY); } },
+		{ "formatValue/derived-50", [&]() { formatValue (descB, derived, FULL_SUMMARY); } },
+		{ "formatChildrenList/array-1M", [&]() { descB.clear(); formatChildrenList (descB, array, arrayexpression, 1, numchildren); } },
+		{ "formatChildrenList/derived-50", [&]() { descB.clear(); formatChildrenList (descB, derived, derivedexpression, 1, numchildren); } },
+		{ "formatChangedList/array-1M", [&]() { descB.clear(); separatorvisible = false;
+				formatChangedList (descB, array, separatorvisible, limits.change_depth_max); } },
+		{ "formatChangedList/derived-50", [&]() { descB.clear(); separatorvisible = false;
+				formatChangedList (descB, derived, separatorvisible, limits.change_depth_max); } },
+		{ "formatRawValue/formats", [&]() {
+				static const unsigned char bytes[8] = { 0x2a, 0x00, 0x00, 0x80, 0xff, 0xff, 0xff, 0xff };
+				for (int format=FORMAT_BINARY; format<=FORMAT_HEXADECIMAL; format++) {
+					descB.clear();
+					formatRawValue (descB, bytes, 4, (ValueFormat)format);
+					descB.clear();
+					formatRawValue (descB, bytes, 8, (ValueFormat)format);
+				} } },
+		{ "formatVariables/locals-20", [&]() { formatVariables (descB, locals); } },
+		{ "formatVariables/locals-20-simple", [&]() { formatVariables (descB, locals, 2, true); } },
+		{ "formatFrame/args", [&]() { descB.clear(); formatFrame (descB, frame, WITH_LEVEL_AND_ARGS); } },
+		{ "formatThreadInfo/threads-10k", [&]() { formatThreadInfo (descB, process, -1); } },
+		{ "formatThreadInfo/thread", [&]() { formatThreadInfo (descB, process, 5000); } },
+		{ "formatExpressionPath/fixups", [&]() {
+				for (int ipath=0; pathsamples[ipath]!=NULL; ipath++) {
+					SyntheticValue pathvalue (SYNTHETIC_INT, "x", pathsamples[ipath], 0);
+					descB.clear();
+					formatExpressionPath (descB, pathvalue);
+				} } },
+		{ "StringB/catsprintf-grow", [&]() {
+				StringB growB;
+				for (int ivar=0; ivar<200; ivar++)
+					growB.catsprintf ("%s{name=\"var%d\",value=\"%d\"}", ivar>0? ",": "", ivar, ivar*7);
+				descB.copy (growB.c_str()); } },
+		{ "StringB/append-char", [&]() {
+				StringB growB(16);
+				for (int ichar=0; ichar<4096; ichar++)
+					growB.append ('x');
+				descB.copy (growB.c_str()); } },
+		{ "StringB/append-reuse", [&]() {
+				descB.clear();
+				for (int ipart=0; ipart<200; ipart++)
+					descB.append ("child={name=\"var1.b\",exp=\"b\",numchild=\"0\"}"); } },
+		{ "StringB/clear-middle", [&]() {
+				descB.clear();
+				for (int ipart=0; ipart<100; ipart++)
+					descB.append (threadsample);
+				while (descB.size() > 64)
+					descB.clear (32, 16); } },
+		{ "scanArgs/eclipse-session", [&]() {
+				static CDT_COMMAND cc;
+				for (int icommand=0; commandsamples[icommand]!=NULL; icommand++) {
+					const char *pc = commandsamples[icommand];
+					while (*pc>='0' && *pc<='9')
+						++pc;
+					strlcpy (cc.arguments, pc, sizeof(cc.arguments));
+					scanArgs (&cc);
+				} } },
+		{ "strfind/forward", [&]() {
+				static char type[LINE_MAX];
+				strlcpy (type, typesample, sizeof(type));
+				strfind (type, "::value_type");
+				strfind (type, "Struct", 1, "<"); } },
+		{ "strfind/backward", [&]() {
+				static char type[LINE_MAX];
+				strlcpy (type, typesample, sizeof(type));
+				strfind (type, "std::", -1);
+				strfind (type, "vector", -1); } },
+		{ "logdata/stopped", [&]() {
+				setlogmask (LOG_CDT_OUT);
+				logdata (LOG_CDT_OUT, stoppedsample, strlen(stoppedsample));
+				setlogmask (LOG_NONE); } },
+		{ "record/done", [&]() { record (descB, "%d^done\n(gdb)\n", 0); } },
+		{ "record/thread-info", [&]() {
+				record (descB, "%d^done,threads=[%s,%s,%s,%s],current-thread-id=\"%d\"\n(gdb)\n",
+						39, threadsample, threadsample, threadsample, threadsample, 1); } },
+		{ "record/stopped", [&]() { record (descB, "%s", stoppedsample); } },
+	};
+
+	if (list) {
+		for (auto &benchmark : benchmarks)
+			printf ("%s\n", benchmark.name);
+		return EXIT_SUCCESS;
+	}
+	FILE *output = stdout;
+	if (outputpath != NULL && (output = fopen (outputpath, "w")) == NULL) {
+		fprintf (stderr, "lldbmi2-microbench: can not write %s\n", outputpath);
+		return EXIT_FAILURE;
+	}
+	fprintf (output, "{\n  \"version\": \"%s\", \"iterations\": %d, \"children_max\": %d,\n  \"benchmarks\": [",
+			LLDBMI2_VERSION, iterations, limits.children_max);
+	const char *separator = "\n";
+	for (auto &benchmark : benchmarks) {
+		bool run = selected.empty();
+		for (size_t iselected=0; iselected<selected.size(); iselected++)
+			if (strncmp (benchmark.name, selected[iselected], strlen(selected[iselected])) == 0)
+				run = true;
+		if (!run)
+			continue;
+		benchmark.run ();			// warm up buffers
+		std::vector<unsigned long long> durations;
+		for (int iiteration=0; iiteration<iterations; iiteration++) {
+			unsigned long long start = nowns();
+			benchmark.run ();
+			durations.push_back (nowns()-start);
+		}
+		BENCHSERIES series = summarize (durations);
+		fprintf (output, "%s    {\"name\": \"%s\", \"bytes\": %d, \"min_ns\": %llu, \"avg_ns\": %llu, \"p50_ns\": %llu, \"p95_ns\": %llu, \"max_ns\": %llu}",
+				separator, benchmark.name, descB.size(), series.min, series.avg, series.p50, series.p95, series.max);
+		separator = ",\n";
+	}
+	fprintf (output, "\n  ]\n}\n");
+	if (output != stdout)
+		fclose (output);
+	return EXIT_SUCCESS;
+}
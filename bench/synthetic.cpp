@@ -0,0 +1,340 @@
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "stringb.h"
+#include "synthetic.h"
+
+#define SYNTHETIC_PID     4242
+#define SYNTHETIC_TID     0x10000
+#define SYNTHETIC_PC      0x401000ULL
+#define SYNTHETIC_ADDRESS 0x7ffe0000ULL
+
+
+SyntheticValue::SyntheticValue (SyntheticKind kind, const char *name, const char *path, long long number)
+	: kind(kind), valuename(name), path(path), number(number)
+{
+	char typebuffer[32];
+	switch (kind) {
+	case SYNTHETIC_INT:
+		type = "int";
+		break;
+	case SYNTHETIC_STRING:
+		type = "char *";
+		break;
+	case SYNTHETIC_ARRAY:
+		snprintf (typebuffer, sizeof(typebuffer), "int [%lld]", number);
+		type = typebuffer;
+		break;
+	case SYNTHETIC_DERIVED:
+		if (number > 0) {
+			snprintf (typebuffer, sizeof(typebuffer), "Derived%lld", number);
+			type = typebuffer;
+		}
+		else
+			type = "Base";
+		break;
+	}
+	valuebuffer[0] = '\0';
+}
+
+bool
+SyntheticValue::isvalid ()
+{
+	return true;
+}
+
+bool
+SyntheticValue::isfailed ()
+{
+	return false;
+}
+
+const char *
+SyntheticValue::errorstring ()
+{
+	return "";
+}
+
+const char *
+SyntheticValue::name ()
+{
+	return valuename.c_str();
+}
+
+const char *
+SyntheticValue::value ()
+{
+	switch (kind) {
+	case SYNTHETIC_INT:
+		snprintf (valuebuffer, sizeof(valuebuffer), "%lld", number);
+		return valuebuffer;
+	case SYNTHETIC_STRING:
+		snprintf (valuebuffer, sizeof(valuebuffer), "0x%016llx", SYNTHETIC_ADDRESS+number);
+		return valuebuffer;
+	default:
+		return NULL;
+	}
+}
+
+const char *
+SyntheticValue::summary ()
+{
+	if (kind == SYNTHETIC_STRING)
+		return "\"synthetic \\\"string\\\"\"";
+	return NULL;
+}
+
+const char *
+SyntheticValue::displaytypename ()
+{
+	return type.c_str();
+}
+
+int
+SyntheticValue::typeflags ()
+{
+	switch (kind) {
+	case SYNTHETIC_STRING:
+		return VIEW_POINTER;
+	case SYNTHETIC_ARRAY:
+		return VIEW_ARRAY;
+	case SYNTHETIC_DERIVED:
+		return VIEW_AGGREGATE;
+	default:
+		return 0;
+	}
+}
+
+int
+SyntheticValue::numchildren ()
+{
+	switch (kind) {
+	case SYNTHETIC_STRING:
+		return 1;
+	case SYNTHETIC_ARRAY:
+		return (int)number;
+	case SYNTHETIC_DERIVED:
+		return number>0? 2: 1;			// base class and member
+	default:
+		return 0;
+	}
+}
+
+ValueRef
+SyntheticValue::childat (int index, bool dynamic)
+{
+	char childname[32];
+	switch (kind) {
+	case SYNTHETIC_STRING:
+		return ValueRef (new SyntheticValue (SYNTHETIC_INT, ("*"+valuename).c_str(), ("*"+path).c_str(), 's'));
+	case SYNTHETIC_ARRAY:
+		snprintf (childname, sizeof(childname), "[%d]", index);
+		return ValueRef (new SyntheticValue (SYNTHETIC_INT, childname, (path+childname).c_str(), index));
+	case SYNTHETIC_DERIVED:
+		if (number>0 && index==0) {		// base class. named as its type
+			snprintf (childname, sizeof(childname), number>1? "Derived%lld": "Base", number-1);
+			return ValueRef (new SyntheticValue (SYNTHETIC_DERIVED, childname, path.c_str(), number-1));
+		}
+		snprintf (childname, sizeof(childname), "m%lld", number);
+		return ValueRef (new SyntheticValue (SYNTHETIC_INT, childname, (path+"."+childname).c_str(), number));
+	default:
+		return ValueRef (new SyntheticValue (SYNTHETIC_INT, "", "", 0));
+	}
+}
+
+void
+SyntheticValue::expressionpath (StringB &pathB)
+{
+	pathB.append (path.c_str());
+}
+
+bool
+SyntheticValue::isinscope ()
+{
+	return true;
+}
+
+bool
+SyntheticValue::isargument ()
+{
+	return false;
+}
+
+unsigned long long
+SyntheticValue::valueasunsigned ()
+{
+	return kind==SYNTHETIC_STRING? SYNTHETIC_ADDRESS+number: number;
+}
+
+unsigned long long
+SyntheticValue::loadaddress ()
+{
+	return SYNTHETIC_ADDRESS + path.size()*8;
+}
+
+void
+SyntheticValue::setprefersynthetic ()
+{
+}
+
+
+void
+SyntheticValueList::add (const SyntheticValue &value)
+{
+	values.push_back (value);
+}
+
+int
+SyntheticValueList::size ()
+{
+	return (int)values.size();
+}
+
+ValueRef
+SyntheticValueList::at (int index)
+{
+	return ValueRef (new SyntheticValue (values[index]));
+}
+
+
+SyntheticFrame::SyntheticFrame (int level) : level(level)
+{
+	snprintf (functionbuffer, sizeof(functionbuffer), "function%d", level);
+}
+
+bool
+SyntheticFrame::isvalid ()
+{
+	return true;
+}
+
+int
+SyntheticFrame::frameid ()
+{
+	return level;
+}
+
+unsigned long long
+SyntheticFrame::pc ()
+{
+	return SYNTHETIC_PC + level*16;
+}
+
+bool
+SyntheticFrame::hasfunction ()
+{
+	return true;
+}
+
+const char *
+SyntheticFrame::functionname ()
+{
+	return functionbuffer;
+}
+
+const char *
+SyntheticFrame::filename ()
+{
+	return "synthetic.cpp";
+}
+
+const char *
+SyntheticFrame::filedirectory ()
+{
+	return "/synthetic/src";
+}
+
+int
+SyntheticFrame::line ()
+{
+	return 100 + level;
+}
+
+const char *
+SyntheticFrame::modulefilename ()
+{
+	return "synthetic";
+}
+
+// arguments of every frame: an int, a string, a class and an array
+ValueListRef
+SyntheticFrame::arguments ()
+{
+	SyntheticValueList *args = new SyntheticValueList;
+	args->add (SyntheticValue (SYNTHETIC_INT, "count", "count", level));
+	args->add (SyntheticValue (SYNTHETIC_STRING, "name", "name", 0));
+	args->add (SyntheticValue (SYNTHETIC_DERIVED, "object", "object", 2));
+	args->add (SyntheticValue (SYNTHETIC_ARRAY, "table", "table", 16));
+	return ValueListRef (args);
+}
+
+
+SyntheticThread::SyntheticThread (int index, int frames) : index(index), frames(frames)
+{
+}
+
+bool
+SyntheticThread::isvalid ()
+{
+	return true;
+}
+
+int
+SyntheticThread::threadid ()
+{
+	return SYNTHETIC_TID + index;
+}
+
+int
+SyntheticThread::indexid ()
+{
+	return index + 1;
+}
+
+int
+SyntheticThread::numframes ()
+{
+	return frames;
+}
+
+FrameRef
+SyntheticThread::frameat (int index)
+{
+	return FrameRef (new SyntheticFrame (index));
+}
+
+
+SyntheticProcess::SyntheticProcess (int threads, int frames) : threads(threads), frames(frames)
+{
+}
+
+bool
+SyntheticProcess::isvalid ()
+{
+	return true;
+}
+
+int
+SyntheticProcess::pid ()
+{
+	return SYNTHETIC_PID;
+}
+
+bool
+SyntheticProcess::isstopped ()
+{
+	return true;
+}
+
+int
+SyntheticProcess::numthreads ()
+{
+	return threads;
+}
+
+ThreadRef
+SyntheticProcess::threadat (int index)
+{
+	return ThreadRef (new SyntheticThread (index, frames));
+}
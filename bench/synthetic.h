@@ -0,0 +1,102 @@
+
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <string>
+#include <vector>
+
+#include "views.h"
+
+// in-memory model of a debugged program implementing the views of views.h
+// children are generated when asked, so a 1M elements array costs nothing until formatted
+
+typedef enum
+{
+	SYNTHETIC_INT,			// int scalar
+	SYNTHETIC_STRING,		// char * with a string summary
+	SYNTHETIC_ARRAY,		// int array of count elements
+	SYNTHETIC_DERIVED		// class at depth levels of single inheritance, with one member per level
+} SyntheticKind;
+
+class SyntheticValue : public ValueView {
+private:
+	SyntheticKind kind;
+	std::string valuename;
+	std::string path;			// expression path
+	std::string type;
+	long long number;			// value of ints, element count of arrays, depth of classes
+	char valuebuffer[32];
+public:
+	SyntheticValue (SyntheticKind kind, const char *name, const char *path, long long number);
+	bool        isvalid ();
+	bool        isfailed ();
+	const char *errorstring ();
+	const char *name ();
+	const char *value ();
+	const char *summary ();
+	const char *displaytypename ();
+	int         typeflags ();
+	int         numchildren ();
+	ValueRef    childat (int index, bool dynamic=false);
+	void        expressionpath (StringB &pathB);
+	bool        isinscope ();
+	bool        isargument ();
+	unsigned long long valueasunsigned ();
+	unsigned long long loadaddress ();
+	void        setprefersynthetic ();
+};
+
+class SyntheticValueList : public ValueListView {
+private:
+	std::vector<SyntheticValue> values;
+public:
+	void        add (const SyntheticValue &value);
+	int         size ();
+	ValueRef    at (int index);
+};
+
+class SyntheticFrame : public FrameView {
+private:
+	int level;
+	char functionbuffer[32];
+public:
+	SyntheticFrame (int level);
+	bool        isvalid ();
+	int         frameid ();
+	unsigned long long pc ();
+	bool        hasfunction ();
+	const char *functionname ();
+	const char *filename ();
+	const char *filedirectory ();
+	int         line ();
+	const char *modulefilename ();
+	ValueListRef arguments ();
+};
+
+class SyntheticThread : public ThreadView {
+private:
+	int index;
+	int frames;
+public:
+	SyntheticThread (int index, int frames);
+	bool        isvalid ();
+	int         threadid ();
+	int         indexid ();
+	int         numframes ();
+	FrameRef    frameat (int index);
+};
+
+class SyntheticProcess : public ProcessView {
+private:
+	int threads;
+	int frames;
+public:
+	SyntheticProcess (int threads, int frames);
+	bool        isvalid ();
+	int         pid ();
+	bool        isstopped ();
+	int         numthreads ();
+	ThreadRef   threadat (int index);
+};
+
+#endif // SYNTHETIC_H
@@ -0,0 +1,52 @@
+#!/bin/sh
+# profile guided and link time optimized build of lldbmi2
+# format: pgo.sh or pgo.sh opt opt ... opt
+# OPT = -DUSE_LIB_PATH=~/sources/llvm-project/build/lib
+# 1. build/ gets the tests programs replayed by tests/scripts
+# 2. build-release/ gets lldbmi2 built Release, the reference
+# 3. build-pgo/ gets lldbmi2 built PgoGenerate, trained by lldbmi2-bench on tests/scripts
+# 4. build-pgo/ gets lldbmi2 rebuilt PgoUse, with the profiles and link time optimization
+# 5. both are replayed PGO_REPEAT times (5). build-pgo/pgo-report.txt compares them
+set -e
+OPT="$*"
+REPEAT=${PGO_REPEAT:-5}
+RELOCATE=/home/didier/projets/c/lldbmi2		# project location recorded in tests/scripts/*.log
+PROJECT=`pwd`
+CORPUS=`ls tests/scripts/*.txt tests/scripts/*.log`
+if [ ! -d "logs" ]; then
+	mkdir logs
+fi
+
+echo "build tests programs"
+cmake -S . -B build $OPT -DBUILD_TESTS=1
+cmake --build build --target tests
+cmake --build build --target inheritance
+
+echo "build release"
+cmake -S . -B build-release $OPT -DCMAKE_BUILD_TYPE=Release
+cmake --build build-release --target lldbmi2
+cmake --build build-release --target lldbmi2-bench
+
+echo "build instrumented"
+rm -rf build-pgo/pgo
+cmake -S . -B build-pgo $OPT -DCMAKE_BUILD_TYPE=PgoGenerate
+cmake --build build-pgo --target lldbmi2 --clean-first
+echo "train with" $CORPUS
+LLVM_PROFILE_FILE=$PROJECT/build-pgo/pgo/lldbmi2-%p.profraw \
+	build-release/lldbmi2-bench --lldbmi2 build-pgo/lldbmi2 --project $PROJECT --relocate $RELOCATE \
+	--output build-pgo/training.json $CORPUS
+if ls build-pgo/pgo/*.profraw >/dev/null 2>&1; then		# clang
+	llvm-profdata merge -output=build-pgo/pgo/default.profdata build-pgo/pgo/*.profraw
+fi
+
+echo "build optimized"
+cmake -S . -B build-pgo $OPT -DCMAKE_BUILD_TYPE=PgoUse
+cmake --build build-pgo --target lldbmi2 --clean-first
+
+echo "compare"
+build-release/lldbmi2-bench --lldbmi2 build-release/lldbmi2 --project $PROJECT --relocate $RELOCATE \
+	--repeat $REPEAT --output build-pgo/release.json $CORPUS
+build-release/lldbmi2-bench --lldbmi2 build-pgo/lldbmi2 --project $PROJECT --relocate $RELOCATE \
+	--repeat $REPEAT --output build-pgo/pgo.json --baseline build-pgo/release.json --threshold 100000 \
+	$CORPUS 2>&1 | tee build-pgo/pgo-report.txt
+echo "optimized lldbmi2 in build-pgo. baseline is build-release, negative changes are gains"
@@ -0,0 +1,68 @@
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "command.h"
+#include "log.h"
+
+
+// convert argument line in a argv vector
+// take care of "
+int
+scanArgs (CDT_COMMAND *cc)
+{
+	logprintf (LOG_TRACE, "scanArgs (0x%x)\n", cc);
+	cc->argc=0;
+	char *pa=cc->arguments, *ps;
+	while (*pa) {
+		if (cc->argc>=MAX_ARGS-2) {		// keep place for final NULL
+			logprintf (LOG_ERROR, "arguments table too small (%d)\n", MAX_ARGS);
+			break;
+		}
+		while (isspace(*pa))
+			++pa;
+		if (*pa=='"') {
+			int ndx = 0;
+			ps = pa;
+			while (*pa) {
+				pa++;
+				if (*pa=='\\' && *(pa+1)=='"')
+					pa = pa+2;
+				if (*pa=='"')
+					pa++;
+				ps[ndx++] = *pa;
+			}
+			ps[ndx] = '\0';
+		}
+		else {
+			ps = pa;
+			while (*pa && !isspace(*pa))
+				++pa;
+			if (isspace(*pa))
+				*pa++ = '\0';
+		}
+		cc->argv[cc->argc++] = ps;
+	}
+	cc->argv[cc->argc] = NULL;
+	return cc->argc;
+}
+
+// convert a print-values argument: 0 or --no-values, 1 or --all-values, 2 or --simple-values
+// return -1 if arg is not a print-values argument, PRINT_INVALID if another number
+int
+scanPrintValues (const char *arg)
+{
+	if (arg == NULL)
+		return -1;
+	if (isdigit(*arg))
+		return (*arg<='2' && arg[1]=='\0')? *arg-'0': PRINT_INVALID;
+	if (strcmp(arg,"--no-values")==0)
+		return PRINT_NO_VALUES;
+	if (strcmp(arg,"--all-values")==0)
+		return PRINT_ALL_VALUES;
+	if (strcmp(arg,"--simple-values")==0)
+		return PRINT_SIMPLE_VALUES;
+	return -1;
+}
@@ -0,0 +1,39 @@
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#ifdef __APPLE__
+#include <sys/syslimits.h>
+#else
+#include <limits.h>
+#endif
+
+
+#define MAX_ARGS 200
+
+
+typedef struct {
+	int sequence;
+	char arguments[LINE_MAX];
+	int argc;
+	const char *argv[MAX_ARGS];
+	char threadgroup[NAME_MAX];
+	int  thread;
+	int  frame;
+	int  available;
+	int  all;
+} CDT_COMMAND;
+
+// print-values argument of -var-update, -var-list-children and -stack-list-xxx
+typedef enum
+{
+	PRINT_INVALID		= -2,		// a number other than 0, 1 and 2
+	PRINT_NO_VALUES		= 0,
+	PRINT_ALL_VALUES	= 1,
+	PRINT_SIMPLE_VALUES	= 2
+} PrintValues;
+
+int         scanArgs       (CDT_COMMAND *cdt_command);
+int         scanPrintValues (const char *arg);
+
+#endif // COMMAND_H
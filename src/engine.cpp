@@ -10,6 +10,10 @@
 #include "lldbmi2.h"
 #include "strlxxx.h"
 #include "log.h"
+#include "trace.h"
+#include "sbstats.h"
+#include "probes.h"
+#include "latency.h"
 #include "engine.h"
 #include "events.h"
 #include "frames.h"
@@ -76,8 +80,25 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 	}
 	else
 		return WAIT_DATA;
+	if (istracing()) {
+		long pending = 0;
+		for (const char *pc=pstate->cdtbufferB.c_str(); *pc; pc++)
+			if (*pc=='\n')
+				++pending;
+		tracecounter ("cdt queue", "commands", pending);
+	}
 
+	tracebegin ("command", "parse", cdtcommandB.c_str());
 	nextarg = evalCDTCommand (pstate, cdtcommandB.c_str(), &cc);
+	traceend ();
+	unsigned long long commandstart = tracenow();
+	bool isresume = false;
+	if (nextarg>0) {
+		setsbcommand (cc.argv[0]);
+		PROBE2 (command_begin, cc.sequence, cc.argv[0]);
+		isresume = steplatencyresume (cc.argv[0]);
+	}
+	TraceSpan dispatchspan ("command", nextarg>0? cc.argv[0]: NULL);
 	if (nextarg==0) {
 	}
 	// MISCELLANOUS COMMANDS
@@ -93,6 +114,55 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		//	"features=[\"frozen-varobjs\",\"pending-breakpoints\",\"thread-info\",\"data-read-memory-bytes\",\"breakpoint-notifications\",\"ada-task-info\",\"python\"]");
 			"features=[\"frozen-varobjs\",\"pending-breakpoints\",\"thread-info\",\"breakpoint-notifications\",\"ada-task-info\",\"python\"]");
 	}
+	else if (strcmp(cc.argv[0],"-lldbmi2-stats")==0) {
+		// -lldbmi2-stats [on|off|reset]
+		// report the SB API calls made by each MI command, the dynamic types and the varobjs
+		// varobjs={count="120",live="80",evicted="12"}: in the table, holding a value, evicted since the start
+		const char *action = nextarg<cc.argc? cc.argv[nextarg]: "";
+		bool known = true;
+		if (strcmp(action,"on")==0)
+			setsbstats (true);
+		else if (strcmp(action,"off")==0)
+			setsbstats (false);
+		else if (strcmp(action,"reset")==0) {
+			resetsbstats ();
+			resetDynamicStats ();
+		}
+		else if (*action != '\0')
+			known = false;
+		if (!known)
+			cdtprintf ("%d^error,msg=\"Unknown argument %s\"\n(gdb)\n", cc.sequence, action);
+		else {
+			static StringB statsdescB(BIG_LINE_MAX), dynamicdescB(LINE_MAX);
+			statsdescB.clear();
+			dynamicdescB.clear();
+			cdtprintf ("%d^done,enabled=\"%s\",sbstats=[%s],dynamic=%s,varobjs={count=\"%d\",live=\"%d\",evicted=\"%d\"}\n(gdb)\n",
+					cc.sequence, issbstats()? "true": "false", formatSBStats (statsdescB), formatDynamicStats (dynamicdescB),
+					pstate->varobjs.size(), pstate->varobjs.livesize(), pstate->varobjs.evicted());
+		}
+	}
+	else if (strcmp(cc.argv[0],"-lldbmi2-step-stats")==0) {
+		// -lldbmi2-step-stats [on|off|reset]
+		// report the latency of the last steps, from resume command to follow-up queries
+		const char *action = nextarg<cc.argc? cc.argv[nextarg]: "";
+		bool known = true;
+		if (strcmp(action,"on")==0)
+			setsteplatency (true);
+		else if (strcmp(action,"off")==0)
+			setsteplatency (false);
+		else if (strcmp(action,"reset")==0)
+			resetsteplatency ();
+		else if (*action != '\0')
+			known = false;
+		if (!known)
+			cdtprintf ("%d^error,msg=\"Unknown argument %s\"\n(gdb)\n", cc.sequence, action);
+		else {
+			static StringB latencydescB(LINE_MAX);
+			latencydescB.clear();
+			cdtprintf ("%d^done,enabled=\"%s\",%s\n(gdb)\n", cc.sequence,
+					issteplatency()? "true": "false", formatStepLatency (latencydescB));
+		}
+	}
 	else if (strcmp(cc.argv[0],"-environment-cd")==0) {
 		// environment-cd /project_path/tests
 		char path[PATH_MAX];
@@ -126,6 +196,7 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		// -gdb-set target-async off
 		// -gdb-set auto-solib-add on
 		// -gdb-set language c
+		// -gdb-set lldbmi2-dynamic dynamic-dont-run-target
 		if (strcmp(cc.argv[nextarg],"args") == 0) {
 			if (strcmp(cc.argv[++nextarg],"%s") == 0) {
 				logprintf (LOG_VARS, "YYYYYYYYYYYY\n");
@@ -156,6 +227,15 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 				addEnvironment (pstate, enventry);
 			}
 		}
+		else if (strcmp(cc.argv[nextarg],"print")==0 && nextarg+2<cc.argc && strcmp(cc.argv[nextarg+1],"object")==0) {
+			// dynamic types without running the program
+			if (strcmp(cc.argv[nextarg+2],"on") == 0)
+				setDynamicPolicy (eDynamicDontRunTarget);
+			else if (strcmp(cc.argv[nextarg+2],"off") == 0)
+				setDynamicPolicy (eNoDynamicValues);
+		}
+		else if (strcmp(cc.argv[nextarg],"lldbmi2-dynamic")==0 && nextarg+1<cc.argc)
+			setDynamicPolicy (scanDynamicPolicy (cc.argv[nextarg+1]));
 		cdtprintf ("%d^done\n(gdb)\n", cc.sequence);
 	}
 	else if (strcmp(cc.argv[0],"-gdb-show")==0) {
@@ -836,15 +916,30 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		else
 			cdtprintf ("%d^error,msg=\"%s\"\n(gdb)\n", cc.sequence, "Can not fetch data now.");
 	}
-	else if (strcmp(cc.argv[0],"-stack-list-locals")==0) {
+	else if (strcmp(cc.argv[0],"-stack-list-locals")==0 || strcmp(cc.argv[0],"-stack-list-variables")==0) {
 		// stack-list-locals --thread 1 --frame 0 1
 		// stack-list-locals --thread 2 --frame 0 1
-		char printvalues[NAME_MAX];		// 1 or --all-values OR 2 or --simple-values
-		printvalues[0] = '\0';
-		if (++nextarg<cc.argc)
-			strlcpy (printvalues, cc.argv[nextarg], sizeof(printvalues));
+		// stack-list-locals --simple-values		^done,locals=[{name="i",type="int",value="3"},{name="s",type="S"}]
+		// stack-list-locals --changed-since 12 1		locals changed after stop 12
+		// ^done,generation="14",locals=[{name="i",value="3"}],out_of_scope=[{name="j"}]
+		// stack-list-variables --no-values		args and locals. ^done,variables=[{name="argc",arg="1"},{name="i"}]
+		bool variables = strcmp(cc.argv[0],"-stack-list-variables") == 0;
+		int printvalues = PRINT_ALL_VALUES;
+		int since = -1;
+		const char *invalidarg = NULL;
+		for (; nextarg<cc.argc && invalidarg==NULL; nextarg++) {
+			if (scanPrintValues (cc.argv[nextarg]) >= 0)			// 1 or --all-values ...
+				printvalues = scanPrintValues (cc.argv[nextarg]);
+			else if (strcmp(cc.argv[nextarg],"--changed-since")==0 && nextarg+1<cc.argc && !variables) {
+				char end;
+				if (sscanf (cc.argv[++nextarg], "%d%c", &since, &end)!=1 || since<0)
+					invalidarg = cc.argv[nextarg];					// not a stop generation
+			}
+			else if (strcmp(cc.argv[nextarg],"--skip-unavailable")!=0 && strcmp(cc.argv[nextarg],"--no-frame-filters")!=0)
+				invalidarg = cc.argv[nextarg];						// those are ignored
+		}
 		bool isValid = false;
-		if (pstate->process.IsValid()) {
+		if (invalidarg==NULL && pstate->process.IsValid()) {
 			SBThread thread = pstate->process.GetSelectedThread();
 			if (thread.IsValid()) {
 				SBFrame frame = thread.GetSelectedFrame();
@@ -852,14 +947,24 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 					SBFunction function = frame.GetFunction();
 					if (function.IsValid()) {
 						isValid = true;
-						SBValueList localvars = frame.GetVariables(0,1,0,0);
-						char *varsdesc = formatVariables (localvars);
-						cdtprintf ("%d^done,locals=[%s]\n(gdb)\n", cc.sequence, varsdesc);
+						// args and locals in one call for -stack-list-variables
+						SBValueList vars = SBCALL (SBFrame_GetVariables, frame.GetVariables(variables,1,0,0));
+						static StringB varsdescB(BIG_LINE_MAX);
+						if (since >= 0) {
+							char *varsdesc = formatChangedVariables (varsdescB, frame, vars, since);
+							cdtprintf ("%d^done,generation=\"%d\",%s\n(gdb)\n", cc.sequence, getStopGeneration(), varsdesc);
+						}
+						else {
+							char *varsdesc = formatVariables (varsdescB, vars, printvalues, variables);
+							cdtprintf ("%d^done,%s=[%s]\n(gdb)\n", cc.sequence, variables? "variables": "locals", varsdesc);
+						}
 					}
 				}
 			}
 		}
-		if (!isValid)
+		if (invalidarg != NULL)
+			cdtprintf ("%d^error,msg=\"%s: Unknown argument %s\"\n(gdb)\n", cc.sequence, cc.argv[0], invalidarg);
+		else if (!isValid)
 			cdtprintf ("%d^error\n(gdb)\n", cc.sequence);
 	}
 	// VARIABLES COMMANDS
@@ -868,11 +973,15 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		// var-create --thread 1 --frame 0 - * a
 		//     name="var1",numchild="0",value="1",type="int",thread-id="1",has_more="0"
 		//     name="var2",numchild="1",value="0x100000f76 \"2\"",type="char *",thread-id="1",has_more=a"0"
-		char expression[NAME_MAX];
+		// var-create watch @ a			floating varobj named watch, evaluated in the selected frame at each stop
+		// var-create - 0x7ffeefbff7f0 a	varobj in the frame of this address
+		char expression[NAME_MAX], name[NAME_MAX];
 		const char *sep = "";
 		*expression = '\0';
-		if (*cc.argv[nextarg]=='-' && *cc.argv[nextarg+1]=='*') {
-			nextarg += 2;
+		if (nextarg+1<cc.argc) {
+			strlcpy (name, cc.argv[nextarg++], sizeof(name));
+			const char *framespec = cc.argv[nextarg++];
+			bool floating = strcmp(framespec,"@") == 0;
 			while (nextarg<cc.argc) {
 				strlcat (expression, sep, sizeof(expression));
 				strlcat (expression, cc.argv[nextarg++], sizeof(expression));
@@ -881,16 +990,27 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 			SBThread thread = pstate->process.GetSelectedThread();
 			if (thread.IsValid()) {
 				SBFrame frame = thread.GetSelectedFrame();
+				if (strcmp(framespec,"*")!=0 && !floating) {			// frame by address
+					unsigned long long frameaddress = strtoull (framespec, NULL, 0);
+					frame = SBFrame();
+					for (uint32_t iframe=0; !frame.IsValid(); iframe++) {
+						SBFrame candidate = thread.GetFrameAtIndex(iframe);
+						if (!candidate.IsValid() || candidate.GetCFA() > frameaddress)
+							break;
+						if (candidate.GetCFA() == frameaddress)
+							frame = candidate;
+					}
+				}
 				if (frame.IsValid()) {
 					// Find then Evaluate to avoid recreate variable
 					SBValue var = getVariable (frame, expression);
-					std::string varName = "var";
-					varName += std::to_string(pstate->nextSessionVariableId++);
-					pstate->sessionVariables[varName] = var;
-					
-					if (var.IsValid() && var.GetError().Success()) {
-						// should remove var.GetError().Success() but update do not work very well
-						updateVarState (var, limits.change_depth_max);
+					// should remove var.GetError().Success() but update do not work very well
+					VAROBJ *varobj = NULL;
+					if (var.IsValid() && var.GetError().Success())
+						varobj = pstate->varobjs.create (strcmp(name,"-")==0? NULL: name, expression, var, frame, floating);
+					if (varobj != NULL) {
+						std::string varName = varobj->name;
+						PROBE2 (varobj_created, varName.c_str(), expression);
 						int varnumchildren = var.GetNumChildren();
 						SBType vartype = var.GetType();
 						static StringB vardescB(VALUE_MAX);
@@ -926,26 +1046,50 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		// 47-var-update 1 var2
 		// 47^done,changelist=[]
 		// 41^done,changelist=[{name="var3",value="44",in_scope="true",type_changed="false",has_more="0"}]
-		int printvalues=1;
+		// 48-var-update --all-values *			all varobjs in one changelist
+		int printvalues = PRINT_ALL_VALUES;
 		char expression[NAME_MAX];
-		if (cc.argv[nextarg] != NULL)							// print-values
-			if (isdigit(*cc.argv[nextarg]))
-				sscanf (cc.argv[nextarg++], "%d", &printvalues);
+		*expression = '\0';
+		int scannedvalues = scanPrintValues (cc.argv[nextarg]);
+		if (scannedvalues >= 0) {								// print-values
+			printvalues = scannedvalues;
+			++nextarg;
+		}
 		if (nextarg<cc.argc)									// variable name
 			strlcpy (expression, cc.argv[nextarg++], sizeof(expression));
 		SBThread thread = pstate->process.GetSelectedThread();
-		if (thread.IsValid()) {
+		if (scannedvalues == PRINT_INVALID)
+			cdtprintf ("%d^error,msg=\"Unknown value for PRINT_VALUES\"\n(gdb)\n", cc.sequence);
+		else if (strcmp(expression,"*") == 0) {
+			static StringB changedescB(BIG_LINE_MAX);
+			changedescB.clear();
+			char *changedesc = pstate->varobjs.updateall (changedescB, thread.GetSelectedFrame(), printvalues);
+			PROBE2 (varobj_updated, expression, strlen(changedesc));
+			cdtprintf ("%d^done,changelist=[%s]\n(gdb)\n", cc.sequence, changedesc);
+		}
+		else if (thread.IsValid()) {
 			SBFrame frame = thread.GetSelectedFrame();
 			if (frame.IsValid()) {
-				SBValue var = getVariable (frame, expression);			// find variable
-				if (var.IsValid() && var.GetError().Success()) {
-					bool separatorvisible = false;
-					SBFunction function = frame.GetFunction();
-					char *changedesc = formatChangedList (var, separatorvisible, limits.change_depth_max);
+				bool separatorvisible = false;
+				VAROBJ *varobj = pstate->varobjs.find (expression, frame);	// find varobj
+				if (varobj != NULL) {
+					// only the varobjs which changed since the previous update
+					static StringB changedescB(BIG_LINE_MAX);
+					changedescB.clear();
+					char *changedesc = pstate->varobjs.update (changedescB, varobj, printvalues, separatorvisible);
+					PROBE2 (varobj_updated, expression, strlen(changedesc));
 					cdtprintf ("%d^done,changelist=[%s]\n(gdb)\n", cc.sequence, changedesc);
 				}
-				else
-					cdtprintf ("%d^done,changelist=[]\n(gdb)\n", cc.sequence);
+				else {
+					SBValue var = getVariable (frame, expression);			// find variable
+					if (var.IsValid() && var.GetError().Success()) {
+						char *changedesc = formatChangedList (var, separatorvisible, limits.change_depth_max);
+						PROBE2 (varobj_updated, expression, strlen(changedesc));
+						cdtprintf ("%d^done,changelist=[%s]\n(gdb)\n", cc.sequence, changedesc);
+					}
+					else
+						cdtprintf ("%d^done,changelist=[]\n(gdb)\n", cc.sequence);
+				}
 			}
 			else
 				cdtprintf ("%d^error\n(gdb)\n", cc.sequence);
@@ -963,51 +1107,120 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		// 52^done,numchild="3",children=[child={name="var5.a",exp="a",numchild="0",type="int",thread-id="1"},child={name="var5.b",exp="b",numchild="1",type="char *",thread-id="1"},child={name="var5.y",exp="y",numchild="4",type="Y *",thread-id="1"}],has_more="0"
 		//|52^done,numchild="3",children=[child={name="z->a",exp="a",numchild="0",type"int",thread-id="1"},child={name="z->b",exp="b",numchild="1",type"char *",thread-id="1"},child={name="z->y",exp="y",numchild="4",type"Y *",thread-id="1"}]",has_more="0"\n(gdb)\n|
 
+		// 62-var-list-children --all-values var6 0 100		children 0 to 99 with their value
+		// 62^done,numchild="100",children=[child={...},...],has_more="1"
+		int printvalues = PRINT_NO_VALUES;
+		if (nextarg<cc.argc && scanPrintValues (cc.argv[nextarg]) >= 0)	// print-values
+			printvalues = scanPrintValues (cc.argv[nextarg++]);
 		char name[NAME_MAX];
 		*name = '\0';
 		if (nextarg<cc.argc)
 			strlcpy (name, cc.argv[nextarg++], sizeof(name));
-		//SBValue var = getVariable (frame, expression);
-		SBValue var = pstate->sessionVariables[name];
+		int from = 0, to = -1;									// window of children
+		if (nextarg+1<cc.argc) {
+			sscanf (cc.argv[nextarg++], "%d", &from);
+			sscanf (cc.argv[nextarg++], "%d", &to);
+		}
+		SBFrame frame = pstate->process.GetSelectedThread().GetSelectedFrame();
+		VAROBJ *varobj = pstate->varobjs.find (name, frame);
+		SBValue var;
+		if (varobj != NULL)
+			var = varobj->value;
 		if (var.IsValid() && var.GetError().Success()) {
-			int varnumchildren = var.GetNumChildren();
-			var.SetPreferDynamicValue(DynamicValueType::eDynamicCanRunTarget);
+			preferDynamic (var);
 			var.SetPreferSyntheticValue(true);
-				
-			std::string childrendesc;
-			for (int i = 0; i < var.GetNumChildren(); ++i) {
-				
-				SBValue child = var.GetChildAtIndex(i);
-				
-				std::string fullName = std::string(name) + "." + child.GetName();
-				
-				if (!childrendesc.empty()) {
-					childrendesc += ",";
+			int varnumchildren = var.GetNumChildren();
+			// without a range, the first children_window children. gdb returns them all
+			if (from < 0 || to < 0) {
+				from = 0;
+				to = limits.children_window;
+			}
+			if (to > varnumchildren)
+				to = varnumchildren;
+			if (from > to)
+				from = to;
+
+			static StringB childrendescB(BIG_LINE_MAX);
+			childrendescB.clear();
+			int listed = 0;
+			for (int ichild = from; ichild < to; ++ichild) {
+				// children are handles. their value is fetched if printed or when used
+				VAROBJ *child = pstate->varobjs.child (varobj, ichild);
+				if (child == NULL)
+					continue;
+				if (listed++ > 0)
+					childrendescB.append (",");
+				childrendescB.catsprintf ("child={name=\"%s\",exp=\"%s\",numchild=\"%d\",",
+						child->name.c_str(), child->expression.c_str(), child->numchildren);
+				if (printvalues==PRINT_ALL_VALUES || (printvalues==PRINT_SIMPLE_VALUES && child->numchildren==0)) {
+					pstate->varobjs.materialize (child);
+					static StringB vardescB(VALUE_MAX);
+					vardescB.clear();
+					childrendescB.catsprintf ("value=\"%s\",", formatValue (vardescB, child->value, FULL_SUMMARY));
 				}
-				childrendesc += "child={";
-				childrendesc += "name=\"";
-				childrendesc += fullName;
-				childrendesc += "\",exp=\"";
-				SBStream s;
-				child.GetExpressionPath(s);
-				childrendesc += child.GetName();
-				childrendesc += "\",numchild=\"";
-				childrendesc += std::to_string(child.GetNumChildren());
-				childrendesc += "\",type=\"";
-				childrendesc += child.GetType().GetDisplayTypeName();
-				childrendesc += "\"}";
-				
-				pstate->sessionVariables[fullName] = child;
+				childrendescB.catsprintf ("type=\"%s\",thread-id=\"%d\"}", child->type.c_str(), child->threadindexid);
 			}
-			
-			// 34^done,numchild="1",children=[child={name="var2.*b",exp="*b",numchild="0",type="char",thread-id="1"}],has_more="0"
-			cdtprintf ("%d^done,numchild=\"%d\",children=[%s]\",has_more=\"0\"\n(gdb)\n",
-					cc.sequence, varnumchildren, childrendesc.c_str());
+			// numchild is the number of children in the list
+			cdtprintf ("%d^done,numchild=\"%d\",children=[%s],has_more=\"%d\"\n(gdb)\n",
+					cc.sequence, listed, childrendescB.c_str(), to<varnumchildren? 1: 0);
 		}
 		else
 			cdtprintf ("%d^error\n(gdb)\n", cc.sequence);
 
 	}
+	else if (strcmp(cc.argv[0],"-var-delete")==0) {
+		// 70-var-delete var1
+		// 70^done,ndeleted="3"
+		// 71-var-delete -c var1			delete only the children
+		bool childrenonly = false;
+		char name[NAME_MAX];
+		*name = '\0';
+		if (nextarg<cc.argc && strcmp(cc.argv[nextarg],"-c")==0) {
+			childrenonly = true;
+			++nextarg;
+		}
+		if (nextarg<cc.argc)
+			strlcpy (name, cc.argv[nextarg++], sizeof(name));
+		int deleted = pstate->varobjs.remove (name, childrenonly);
+		if (deleted >= 0)
+			cdtprintf ("%d^done,ndeleted=\"%d\"\n(gdb)\n", cc.sequence, deleted);
+		else
+			cdtprintf ("%d^error,msg=\"Variable object not found\"\n(gdb)\n", cc.sequence);
+	}
+	else if (strcmp(cc.argv[0],"-var-set-frozen")==0) {
+		// 72-var-set-frozen var1 1		var1 and its children are not updated by a parent or by *
+		// 72^done
+		char name[NAME_MAX];
+		*name = '\0';
+		int frozen = -1;
+		if (nextarg<cc.argc)
+			strlcpy (name, cc.argv[nextarg++], sizeof(name));
+		if (nextarg<cc.argc)
+			sscanf (cc.argv[nextarg++], "%d", &frozen);
+		if (frozen!=0 && frozen!=1)
+			cdtprintf ("%d^error,msg=\"Invalid flag value\"\n(gdb)\n", cc.sequence);
+		else if (pstate->varobjs.setfrozen (name, frozen==1))
+			cdtprintf ("%d^done\n(gdb)\n", cc.sequence);
+		else
+			cdtprintf ("%d^error,msg=\"Variable object not found\"\n(gdb)\n", cc.sequence);
+	}
+	else if (strcmp(cc.argv[0],"-var-set-update-range")==0) {
+		// 73-var-set-update-range var1 100 150		-var-update reports only children 100 to 149
+		// 73^done
+		char name[NAME_MAX];
+		*name = '\0';
+		int from = -1, to = -1;
+		if (nextarg<cc.argc)
+			strlcpy (name, cc.argv[nextarg++], sizeof(name));
+		if (nextarg+1<cc.argc) {
+			sscanf (cc.argv[nextarg++], "%d", &from);
+			sscanf (cc.argv[nextarg++], "%d", &to);
+		}
+		if (pstate->varobjs.setupdaterange (name, from, to))
+			cdtprintf ("%d^done\n(gdb)\n", cc.sequence);
+		else
+			cdtprintf ("%d^error,msg=\"Variable object not found\"\n(gdb)\n", cc.sequence);
+	}
 	else if (strcmp(cc.argv[0],"-var-info-path-expression")==0) {
 		// 35-var-info-path-expression var2.*b
 		// 35^done,path_expr="*(b)"
@@ -1026,7 +1239,10 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 			if (thread.IsValid()) {
 				SBFrame frame = thread.GetSelectedFrame();
 				if (frame.IsValid()) {
-					SBValue var = pstate->sessionVariables[expression];
+					VAROBJ *varobj = pstate->varobjs.find (expression, frame);
+					SBValue var;
+					if (varobj != NULL)
+						var = varobj->value;
 					if (var.IsValid() && var.GetError().Success()) {
 						char *expressionpathdesc = formatExpressionPath (var);
 						cdtprintf ("%d^done,path_expr=\"%s\"\n(gdb)\n", cc.sequence, expressionpathdesc);
@@ -1060,7 +1276,10 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 			if (thread.IsValid()) {
 				SBFrame frame = thread.GetSelectedFrame();
 				if (frame.IsValid()) {
-					SBValue var = pstate->sessionVariables[expression];
+					VAROBJ *varobj = pstate->varobjs.find (expression, frame);
+					SBValue var;
+					if (varobj != NULL)
+						var = varobj->value;
 					if (var.IsValid()) {
 						char *vardesc = formatValue (var, FULL_SUMMARY);
 						cdtprintf ("%d^done,value=\"%s\"\n(gdb)\n", cc.sequence, vardesc);
@@ -1104,7 +1323,7 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		if (takeAddrOp != NULL) 
 			*takeAddrOp = '&';
 
-		SBValue val = target.EvaluateExpression(expression);
+		SBValue val = SBCALL_DETAIL (SBTarget_EvaluateExpression, expression, target.EvaluateExpression(expression));
 		if (val.IsValid() && (pathStart != NULL)) {
 			val = val.GetValueForExpressionPath(expressionPath);
 		}
@@ -1275,31 +1494,31 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		// 36^done,format="natural",value="0x100000f94 \"22\""
 		// 36^done,format="natural",value="50 '2'"
 		char expression[NAME_MAX], format[NAME_MAX];
+		*expression = *format = '\0';
 		if (nextarg<cc.argc)
 			strlcpy (expression, cc.argv[nextarg++], sizeof(expression));
 		if (nextarg<cc.argc)
 			strlcpy (format, cc.argv[nextarg++], sizeof(format));
-		Format formatcode;
-		if (strcmp(format,"binary")==0)
-			formatcode = eFormatBinary;
-		else if (strcmp(format,"octal")==0)
-			formatcode = eFormatOctal;
-		else if (strcmp(format,"decimal")==0)
-			formatcode = eFormatDecimal;
-		else if (strcmp(format,"hexadecimal")==0)
-			formatcode = eFormatHex;
-		else
-			formatcode = eFormatDefault;
+		ValueFormat valueformat = scanValueFormat (format);
 		SBThread thread = pstate->process.GetSelectedThread();
 		if (thread.IsValid()) {
 			SBFrame frame = thread.GetSelectedFrame();
 			if (frame.IsValid()) {
-				SBValue var = getVariable (frame, expression);
-				if (var.IsValid() && var.GetError().Success()) {
-					var.SetFormat(formatcode);
-					char *vardesc = formatValue (var, FULL_SUMMARY);		// was NO_SUMMARY
-					cdtprintf ("%d^done,format=\"%s\",value=\"%s\"\n(gdb)\n", cc.sequence, format, vardesc);
+				static StringB vardescB(VALUE_MAX);
+				vardescB.clear();
+				char *vardesc = NULL;
+				VAROBJ *varobj = pstate->varobjs.find (expression, frame);
+				if (varobj != NULL)					// formatted again from the bytes of this stop
+					vardesc = pstate->varobjs.setformat (vardescB, varobj, valueformat);
+				else {
+					SBValue var = getVariable (frame, expression);
+					if (var.IsValid() && var.GetError().Success()) {
+						var.SetFormat(formatcodes[valueformat]);
+						vardesc = formatValue (vardescB, var, FULL_SUMMARY);		// was NO_SUMMARY
+					}
 				}
+				if (vardesc != NULL)
+					cdtprintf ("%d^done,format=\"%s\",value=\"%s\"\n(gdb)\n", cc.sequence, format, vardesc);
 				else
 					cdtprintf ("%d^error\n(gdb)\n", cc.sequence);
 			}
@@ -1740,7 +1959,7 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 			else {
 				size_t size = wordSize * nrCols * nrRows;
 				void *buf = malloc(size);
-				size_t readCnt = pstate->process.ReadMemory(address, buf, size, error);
+				size_t readCnt = SBCALL (SBProcess_ReadMemory, pstate->process.ReadMemory(address, buf, size, error));
 				if (error.Fail() || (readCnt == 0)) {
 					SBStream s;
 					error.GetDescription(s);
@@ -1812,6 +2031,11 @@ fromCDT (STATE *pstate, const char *commandLine, int linesize)			// from cdt
 		logdata (LOG_NOHEADER, cc.argv[0], strlen(cc.argv[0]));
 		cdtprintf ("%d^error,msg=\"%s\"\n(gdb)\n", cc.sequence, "Command unimplemented.");
 	}
+	if (nextarg>0) {
+		PROBE2 (command_end, cc.sequence, cc.argv[0]);
+		if (!isresume && strncmp(cc.argv[0],"-lldbmi2-",9)!=0)
+			steplatencyfollowup (commandstart);
+	}
 	return dataflag;
 }
 
@@ -1909,45 +2133,3 @@ evalCDTCommand (STATE *pstate, const char *cdtcommand, CDT_COMMAND *cc)
 
 	return field;
 }
-
-
-// convert argument line in a argv vector
-// take care of "
-int
-scanArgs (CDT_COMMAND *cc)
-{
-	logprintf (LOG_TRACE, "scanArgs (0x%x)\n", cc);
-	cc->argc=0;
-	char *pa=cc->arguments, *ps;
-	while (*pa) {
-		if (cc->argc>=MAX_ARGS-2) {		// keep place for final NULL
-			logprintf (LOG_ERROR, "arguments table too small (%d)\n", MAX_ARGS);
-			break;
-		}
-		while (isspace(*pa))
-			++pa;
-		if (*pa=='"') {
-			int ndx = 0;
-			ps = pa;
-			while (*pa) {
-				pa++;
-				if (*pa=='\\' && *(pa+1)=='"')
-					pa = pa+2;
-				if (*pa=='"')
-					pa++;
-				ps[ndx++] = *pa;
-			}
-			ps[ndx] = '\0';
-		}
-		else {
-			ps = pa;
-			while (*pa && !isspace(*pa))
-				++pa;
-			if (isspace(*pa))
-				*pa++ = '\0';
-		}
-		cc->argv[cc->argc++] = ps;
-	}
-	cc->argv[cc->argc] = NULL;
-	return cc->argc;
-}
@@ -5,8 +5,13 @@
 #include <unistd.h>
 #include "lldbmi2.h"
 #include "log.h"
+#include "trace.h"
+#include "sbstats.h"
+#include "probes.h"
+#include "latency.h"
 #include "events.h"
 #include "frames.h"
+#include "variables.h"
 
 
 extern LIMITS limits;
@@ -87,12 +92,15 @@ processListener (void *arg)
 	if (!pstate->listener.IsValid())
 		return NULL;
 
+	tracethread ("listener");
+	setsbcommand ("(listener)");
 	while (!pstate->eof && !pstate->procstop) {
 		SBEvent event;
 		bool gotevent = pstate->listener.WaitForEvent (1, event);
 		if (!gotevent || !event.IsValid())
 			continue;
 		uint32_t eventtype = event.GetType();
+		TraceSpan span ("event", event.GetBroadcasterClass());
 		if (SBProcess::EventIsProcessEvent(event)) {
 			StateType processstate = process.GetState();
 			switch (eventtype) {
@@ -117,7 +125,10 @@ processListener (void *arg)
 					break;
 				case eStateStopped:
 					logprintf (LOG_EVENTS, "eStateStopped\n");
+					PROBE1 (stop_event_received, processstate);
+					steplatencystopreceived ();
 					onStopped (pstate, process);
+					setsbcommand ("(listener)");		// onStopped may return early
 					break;
 				default:
 					logprintf (LOG_WARN, "unexpected process state %d\n", processstate);
@@ -151,6 +162,7 @@ processListener (void *arg)
 						*pd++ = *ps++;
 					} while (*(ps-1));
 					writelog ((pstate->ptyfd!=EOF)?pstate->ptyfd:STDOUT_FILENO, iobuffer, iobytes);
+					PROBE1 (inferior_output_forwarded, iobytes);
 				}
 				logdata (LOG_PROG_IN, iobuffer, iobytes);
 				break;
@@ -174,6 +186,9 @@ void
 onStopped (STATE *pstate, SBProcess process)
 {
 	logprintf (LOG_TRACE, "onStopped (0x%x, 0x%x)\n", pstate, &process);
+	TraceSpan span ("event", "onStopped");
+	setsbcommand ("*stopped");
+	nextStopGeneration ();						// variables found at the previous stop are gone
 //	-3-38-5.140 <<=  |=breakpoint-modified,bkpt={number="breakpoint 1",type="breakpoint",disp="del",enabled="y",addr="0x0000000100000f06",func="main",file="tests.c",fullname="tests.c",line="33",thread-groups=["i1"],times="1",original-location="tests.c:33"}\n|
 //	-3-38-5.140 <<=  |*stopped,reason="breakpoint-hit",disp="keep",bkptno="breakpoint 1",frame={addr="0x0000000100000f06",func="main",args=[],file="tests.c",fullname="tests.c",line="33"},thread-id="1",stopped-threads="all"\n|
 //	-3-40-7.049 <<=  |*stopped,reason="breakpoint-hit",disp="keep",bkptno="1",frame={addr="0000000000000f06",func="main",args=[],file="tests.c",fullname="/project_path/tests/Debug/../Sources/tests.c",line="33"},thread-id="1",stopped-threads="all"(gdb)\n|
@@ -187,6 +202,7 @@ onStopped (STATE *pstate, SBProcess process)
     	return;
     }
 	int stopreason = thread.GetStopReason();
+	bool emitted = false;						// *stopped written
 //	logprintf (LOG_EVENTS, "stopreason=%d\n", stopreason);
 	if (stopreason==eStopReasonBreakpoint || stopreason==eStopReasonPlanComplete) {
 		int bpid=0;
@@ -216,6 +232,7 @@ onStopped (STATE *pstate, SBProcess process)
 		int threadindexid=thread.GetIndexID();
 		cdtprintf ("*stopped,%s%s,thread-id=\"%d\",stopped-threads=\"all\"\n(gdb)\n",
 					reasondesc,framedesc,threadindexid);
+		emitted = true;
 	//	cdtprintf ("*stopped,reason=\"breakpoint-hit\",disp=\"keep\",bkptno=\"1\",frame={addr=\"0x0000000100000f06\",func=\"main\",args=[],file=\"../Sources/tests.c\",fullname=\"/project_path/tests/Sources/tests.c\",line=\"33\"},thread-id=\"1\",stopped-threads=\"all\"\n(gdb) \n");
 		if (strcmp(dispose,"del")==0) {
 			target.BreakpointDelete(bpid);
@@ -253,6 +270,7 @@ onStopped (STATE *pstate, SBProcess process)
 		}
 		else
 			cdtprintf ("*stopped,reason=\"watchpoint-trigger\"}\n(gdb)\n");
+		emitted = true;
 	}
 	else if (stopreason==eStopReasonSignal) {
 		// raised when attaching to a process
@@ -272,6 +290,7 @@ onStopped (STATE *pstate, SBProcess process)
 		//signal-name="SIGSEGV",signal-meaning="Segmentation fault"
 		cdtprintf ("*stopped,%s%s,thread-id=\"%d\",stopped-threads=\"all\"\n(gdb)\n",
 					reasondesc, framedesc, threadindexid);
+		emitted = true;
 		// *stopped,reason="signal-received",signal-name="SIGSEGV",signal-meaning="Segmentation fault",frame={addr="0x0000000100000f7b",func="main",args=[],file="../Sources/tests.cpp",fullname="/project_path/test_hello_cpp/Sources/tests.cpp",line="44"},thread-id="1",stopped-threads="all"
 	}
 	else if (stopreason==eStopReasonNone) {
@@ -291,9 +310,14 @@ onStopped (STATE *pstate, SBProcess process)
 		int threadindexid = thread.GetIndexID();
 		cdtprintf ("*stopped,%sthread-id=\"%d\",stopped-threads=\"all\"\n(gdb)\n",
 					reasondesc, threadindexid);
+		emitted = true;
 	}
 	else
 		logprintf (LOG_WARN, "unexpected stop reason %d\n", stopreason);
+	if (emitted) {
+		PROBE1 (stopped_emitted, stopreason);
+		steplatencystopemitted ();
+	}
 	pstate->isrunning = false;
 }
 
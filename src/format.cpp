@@ -0,0 +1,502 @@
+
+#include <string.h>
+#include <ctype.h>
+#include <string>
+
+#include "format.h"
+#include "log.h"
+#include "trace.h"
+
+extern LIMITS limits;
+
+// return first or last occurrence of find. If except not null and find first, return NULL
+// if way==1, like strstr, if way=-1, like strrstr
+char *
+strfind (char *string, const char *find, int way, const char *except)
+{
+	size_t stringlen, findlen, exceptlen=0;
+	char *cp;
+	stringlen = strlen(string);
+	findlen = strlen(find);
+	if (except!=NULL)
+		exceptlen = strlen(except);
+	if (findlen > stringlen)
+		return NULL;
+	for (cp=way>0? string: string+stringlen-findlen; cp>=string && cp<=string+stringlen-findlen; cp+=way) {
+		if (except!=NULL && cp<string+stringlen-exceptlen) {
+			if (strncmp(cp, except, findlen) == 0)
+				return NULL;
+		}
+		if (strncmp(cp, find, findlen) == 0)
+			return cp;
+	}
+	return NULL;
+}
+
+char *
+strup (char *string, int len)
+{
+	char *p = string;
+	while (*p) {
+		*p = toupper(*p);
+		p++;
+		if ((len != -1) && ((p - string) >= len))
+			break;
+	}
+	return string;
+}
+
+// return the name of a variable
+// adjust the name if NULL
+const char *
+getName (ValueView &var)
+{
+	const char *varname = var.name();
+	if (varname == NULL)
+		varname = "(anonymous)";
+	return varname;
+}
+
+char *
+formatExpressionPath (StringB &expressionpathdescB, ValueView &var)
+{
+	logprintf (LOG_TRACE, "formatExpressionPath (0x%x, 0x%x)\n", &expressionpathdescB, &var);
+	// child expressions: var2.*b
+	var.expressionpath (expressionpathdescB);
+	if (var.name()==NULL)
+		expressionpathdescB.append("(anonymous)");
+	logprintf (LOG_DEBUG, "formatExpressionPath: expressionpathdesc=%s\n", expressionpathdescB.c_str());
+	// correct expression
+	char *pstr=expressionpathdescB.c_str(), *pp;
+	int suppress;
+	do {
+		suppress = 0;
+		if ((pp=strstr(pstr,"->[")) != NULL)
+			suppress = 2;
+		else if ((pp=strstr(pstr,".[")) != NULL)
+			suppress = 1;
+		else if ((pp=strstr(pstr,"..")) != NULL)
+			suppress = 1;		// may happen if unions with no name
+		if (suppress > 0)		// remove the offending characters
+			expressionpathdescB.clear(suppress,pp-pstr);		// bytes, start
+	} while (suppress>0);
+	if (expressionpathdescB.size()>0)
+		if (expressionpathdescB.c_str()[expressionpathdescB.size()-1]=='.')
+			expressionpathdescB.c_str()[expressionpathdescB.size()-1] = '\0';		// remove final '.'
+	return expressionpathdescB.c_str();
+}
+
+// list children variables
+char *
+formatChildrenList (StringB &childrendescB, ValueView &var, char *expression, int threadindexid, int &varnumchildren)
+{
+	logprintf (LOG_TRACE, "formatChildrenList (0x%x, 0x%x, %s, %d, %d)\n", &childrendescB, &var, expression, threadindexid, varnumchildren);
+	TraceSpan span ("format", "formatChildrenList");
+	var.setprefersynthetic ();
+	varnumchildren = var.numchildren();
+	const char *sep="";
+	int childrenmax = varnumchildren<limits.children_max? varnumchildren: limits.children_max;
+	for (int ichild=0; ichild<childrenmax; ichild++) {
+		ValueRef child = var.childat (ichild, true);
+		if (!child->isvalid())
+			continue;
+		const char *childname = getName(*child);				// displayed name
+		if (child->isfailed())
+			logprintf (LOG_DEBUG, "formatChildrenList: error on child %s: %s\n", childname, child->errorstring());
+		child->setprefersynthetic ();
+		int childnumchildren = child->numchildren();
+		const char *displaytypename = child->displaytypename();
+		static StringB expressionpathdescB(NAME_MAX);			// real path
+		expressionpathdescB.clear();							// clear previous buffer content
+		if (strcmp(childname,displaytypename)==0)				// if extends class name
+			expressionpathdescB.catsprintf("%s.%s", expression, childname);
+		else {
+			formatExpressionPath (expressionpathdescB, *child);
+			if (strcmp((const char *)expression,(const char *)expressionpathdescB.c_str())==0) {
+				logprintf (LOG_ALL, "formatChildrenList: Var=%-5s: children=%-2d, typeflags=0x%x\n",
+						getName(var), varnumchildren, var.typeflags());
+				if (childnumchildren>0)							// breakpoint 1 in largearray.log
+					// special case with casts like StringB or Vector. Add the name to the expression
+					childrendescB.catsprintf (".%s", childname);
+			}
+		}
+		logprintf (LOG_DEBUG, "formatChildrenList (expressionpathdesc=%s, childchildren=%d, childname=%s)\n",
+				expressionpathdescB.c_str(), childnumchildren, childname);
+		// [child={name="var2.*b",exp="*b",numchild="0",type="char",thread-id="1"}]
+		childrendescB.catsprintf ("%schild={name=\"%s\",exp=\"%s\",numchild=\"%d\","
+			"type=\"%s\",thread-id=\"%d\"}",
+			sep, (std::string(expression) + childname).c_str(), childname,childnumchildren,displaytypename,threadindexid);
+		sep = ",";
+	}
+	return childrendescB.c_str();
+}
+
+// search changed variables
+char *
+formatChangedList (StringB &changedescB, ValueView &var, bool &separatorvisible, int depth)
+{
+	logprintf (LOG_TRACE, "formatChangedList (0x%x, 0x%x, %B, %d)\n", &changedescB, &var, separatorvisible, depth);
+	static StringB expressionpathdescB(NAME_MAX);
+	expressionpathdescB.clear();
+	formatExpressionPath (expressionpathdescB, var);
+	if (expressionpathdescB.size()==0)
+		return changedescB.c_str();
+	const char *varvalue = var.value();				// required to get value to activate changes
+	const char *varsummary = var.summary();			// required to get value to activate changes
+	logprintf (LOG_DEBUG, "formatChangedList: name=%s, expressionpath=%s, value=%s, summary=%s\n",
+			getName(var), expressionpathdescB.c_str(), varvalue, varsummary);
+	int typeflags = var.typeflags();
+	int varnumchildren = var.numchildren();
+	const char *separator = separatorvisible? ",":"";
+	const char *varinscope = var.isinscope()? "true": "false";
+	static StringB vardescB(VALUE_MAX);
+	vardescB.clear();								// clear previous buffer content
+	formatValue (vardescB,var, FULL_SUMMARY);		// was NO_SUMMARY
+	changedescB.catsprintf ("%s{name=\"%s\",value=\"%s\",in_scope=\"%s\",type_changed=\"false\",has_more=\"0\"}",
+		separator, expressionpathdescB.c_str(), vardescB.c_str(), varinscope);
+	separatorvisible = true;
+	if (!(typeflags&VIEW_ARRAY)) {
+		int childrenmax = varnumchildren<limits.children_max? varnumchildren: limits.children_max;
+		for (int ichild = 0; ichild < childrenmax; ++ichild) {
+			ValueRef child = var.childat (ichild);
+			if (!child->isvalid() || var.isfailed())
+				continue;
+			child->setprefersynthetic ();
+			// Handle composite types (i.e. struct or arrays)
+			if (depth>1)
+				formatChangedList (changedescB, *child, separatorvisible, depth-1);
+		}
+	}
+	return changedescB.c_str();
+}
+
+
+// format a list of variables into a GDB string
+// called for arguments and locals var after a breakpoint
+char *
+formatVariables (StringB &varsdescB, ValueListView &varslist)
+{
+	return formatVariables (varsdescB, varslist, 1, false);
+}
+
+// format a list of variables with the print-values of the MI commands
+// printvalues: 0 names only, 1 all values, 2 types, and values of types which are not aggregates nor arrays
+// witharguments: flag the arguments and always use tuples, as -stack-list-variables
+// name="a",name="b" or {name="a",arg="1",value="1"} or {name="s",type="struct S"}
+char *
+formatVariables (StringB &varsdescB, ValueListView &varslist, int printvalues, bool witharguments)
+{
+	logprintf (LOG_TRACE, "formatVariables (0x%x, 0x%x, %d)\n", varsdescB.c_str(), &varslist, printvalues);
+	TraceSpan span ("format", "formatVariables");
+	varsdescB.clear();
+	const char *separator="";
+	int size = varslist.size();
+	for (int i=0; i<size; i++) {
+		ValueRef var = varslist.at (i);
+		var->setprefersynthetic ();
+		if (var->isvalid() && !var->isfailed()) {
+			logprintf (LOG_DEBUG, "formatVariables: var=%s\n", getName(*var));
+			bool tuple = printvalues!=0 || witharguments;
+			varsdescB.catsprintf ("%s%sname=\"%s\"", separator, tuple? "{": "", getName(*var));
+			if (witharguments && var->isargument())
+				varsdescB.append (",arg=\"1\"");
+			bool withvalue = printvalues == 1;
+			if (printvalues == 2) {
+				const char *vartype = var->displaytypename();
+				varsdescB.catsprintf (",type=\"%s\"", vartype!=NULL? vartype: "");
+				withvalue = !(var->typeflags() & (VIEW_ARRAY|VIEW_AGGREGATE));
+			}
+			if (withvalue) {
+				static StringB vardescB(BIG_VALUE_MAX);
+				vardescB.clear();								// clear previous buffer content
+				formatValue (vardescB, *var, FULL_SUMMARY);
+				varsdescB.catsprintf (",value=\"%s\"", vardescB.c_str());
+			}
+			if (tuple)
+				varsdescB.append ("}");
+			separator=",";
+		}
+	}
+	return varsdescB.c_str();
+}
+
+char *
+formatSummary (StringB &summarydescB, ValueView &var)
+{
+	logprintf (LOG_TRACE, "formatSummary (0x%x, 0x%x)\n", &summarydescB, &var);
+	//	value = "HFG\123klj\b"
+	//	value={2,5,7,0 <repeat 5 times>, 7}
+	//	value = {{a=1,b=0x33},...{a=1,b=2}}
+	const char *varsummary = var.summary();
+	if (varsummary && *varsummary == '"') {				// string
+		// copy varsummary in summarydescB.exclude heading & trainling apostrophe. escape inner apostrophes if required
+		for (const char *ps=varsummary+1; *ps&&*(ps+1); ps++) {
+			if (*ps=='"' && *(ps-1)!='\\')
+				summarydescB.append ('\\');
+			summarydescB.append (*ps);
+		}
+		return summarydescB.c_str();
+	}
+	int typeflags = var.typeflags();
+	int numchildren = var.numchildren();
+	logprintf (LOG_DEBUG, "formatSummary: Var=%-5s: children=%-2d, typeflags=0x%x\n", getName(var), numchildren, typeflags);
+
+	if (typeflags & (VIEW_AGGREGATE|VIEW_ARRAY)) {
+		const char *separator="";
+		static StringB vardescB(VALUE_MAX);
+		if (varsummary && *varsummary) {
+			summarydescB.append(varsummary);
+			summarydescB.append(" ");
+		}
+		summarydescB.append("{");
+		int childrenmax = numchildren<limits.children_max? numchildren: limits.children_max;
+		for (int ichild=0; ichild<childrenmax; ichild++) {
+			ValueRef child = var.childat (ichild);
+			if (!child->isvalid() || var.isfailed())
+				continue;
+			child->setprefersynthetic ();
+			const char *childvalue = child->value();
+			vardescB.clear();						// clear previous buffer content
+			if (childvalue != NULL)
+				if (typeflags & VIEW_ARRAY)
+					vardescB.catsprintf ("%s%s", separator, childvalue);
+				else
+					vardescB.catsprintf ("%s%s=%s", separator, getName(*child), childvalue);
+			else {
+				unsigned long long childaddr;
+				if (typeflags & (VIEW_POINTER|VIEW_REFERENCE))
+					childaddr = var.valueasunsigned();
+				else
+					childaddr = var.loadaddress();
+				if (typeflags & VIEW_ARRAY)
+					vardescB.catsprintf ("%s%p", separator, childaddr);
+				else
+					vardescB.catsprintf ("%s%s=%p", separator, getName(*child), childaddr);
+			}
+			summarydescB.append(vardescB.c_str());
+			separator = ",";
+		}
+		summarydescB.append("}");
+		return summarydescB.c_str();
+	}
+	return NULL;
+}
+
+// format a variable description into a GDB string
+char *
+formatValue (StringB &vardescB, ValueView &var, VariableDetails details)
+{
+	logprintf (LOG_TRACE, "formatValue (0x%x, 0x%x, %x)\n", &vardescB, &var, details);
+	//	value = "HFG\123klj\b"
+	//	value={2,5,7,0 <repeat 5 times>, 7}
+	//	value = {{a=1,b=0x33},...{a=1,b=2}}
+	vardescB.clear();
+	if (var.isfailed())		// invalid value. show nothing
+		return vardescB.c_str();
+	int typeflags = var.typeflags();
+	const char *varname = getName(var);
+	static StringB summarydescB(BIG_LINE_MAX);
+	summarydescB.clear();								// clear previous buffer content
+	formatSummary (summarydescB, var);
+	const char *varvalue = var.value();
+	unsigned long long varaddr;
+	if (typeflags & (VIEW_POINTER|VIEW_REFERENCE))
+		varaddr = var.valueasunsigned();
+	else
+		varaddr = var.loadaddress();
+	logprintf (LOG_DEBUG, "formatValue: var=%p, name=%s, typeflags=0x%x, summary=%s, value=%s, address=%p\n",
+			&var, varname, typeflags, summarydescB.c_str(), varvalue, varaddr);
+
+	if (varvalue != NULL) {			// basic types and arrays
+		if (typeflags & (VIEW_POINTER|VIEW_REFERENCE|VIEW_ARRAY)) {
+			if (summarydescB.size()>0 && details==FULL_SUMMARY)
+				vardescB.catsprintf ("%s \\\"%s\\\"", varvalue, summarydescB.c_str());
+			else
+				vardescB.catsprintf ("%s", varvalue);
+		}
+		else		// basic type
+			vardescB.append(varvalue);
+	}
+	// classes and structures
+	else if (summarydescB.size()>0 && details==FULL_SUMMARY)
+		vardescB.catsprintf ("%p \\\"%s\\\"", varaddr, summarydescB.c_str());
+	else
+		vardescB.catsprintf ("%p", varaddr);
+	return vardescB.c_str();
+}
+
+// get the format of a -var-set-format name. natural if unknown
+ValueFormat
+scanValueFormat (const char *format)
+{
+	if (strcmp(format,"binary")==0)
+		return FORMAT_BINARY;
+	else if (strcmp(format,"octal")==0)
+		return FORMAT_OCTAL;
+	else if (strcmp(format,"decimal")==0)
+		return FORMAT_DECIMAL;
+	else if (strcmp(format,"hexadecimal")==0)
+		return FORMAT_HEXADECIMAL;
+	return FORMAT_NATURAL;
+}
+
+// format the raw bytes of a scalar (little endian, up to 8 bytes) as LLDB formats them
+// 0b00101010, 052, 42, 0x2a. decimal values are signed. return NULL if it can not
+// be formatted, as natural formats depend on the type
+char *
+formatRawValue (StringB &vardescB, const unsigned char *bytes, int size, ValueFormat format)
+{
+	static const char digits[] = "0123456789abcdef";
+	if (size<1 || size>8 || format==FORMAT_NATURAL)
+		return NULL;
+	unsigned long long value = 0;
+	for (int ibyte=size-1; ibyte>=0; ibyte--)
+		value = (value<<8) | bytes[ibyte];
+	char text[2+64+1], *pt = text+sizeof(text);
+	*--pt = '\0';
+	switch (format) {
+	case FORMAT_BINARY:
+		for (int ibit=0; ibit<size*8; ibit++, value>>=1)
+			*--pt = '0' + (value&1);
+		*--pt = 'b';
+		*--pt = '0';
+		break;
+	case FORMAT_OCTAL:
+		do {
+			*--pt = '0' + (value&7);
+			value >>= 3;
+		} while (value != 0);
+		*--pt = '0';
+		break;
+	case FORMAT_DECIMAL: {
+		unsigned long long mask = size<8? (1ULL<<(size*8))-1: ~0ULL;
+		bool negative = (value>>(size*8-1))&1;
+		if (negative)									// magnitude of the two's complement
+			value = (0-value) & mask;
+		do {
+			*--pt = '0' + value%10;
+			value /= 10;
+		} while (value != 0);
+		if (negative)
+			*--pt = '-';
+		break;
+	}
+	default:											// FORMAT_HEXADECIMAL
+		for (int idigit=0; idigit<size*2; idigit++, value>>=4)
+			*--pt = digits[value&15];
+		*--pt = 'x';
+		*--pt = '0';
+		break;
+	}
+	vardescB.append (pt);
+	return vardescB.c_str();
+}
+
+
+// format a frame description into a GDB string
+char *
+formatFrame (StringB &framedescB, FrameView &frame, FrameDetails framedetails)
+{
+	logprintf (LOG_TRACE, "formatFrame (0x%x, 0x%x, 0x%x)\n", &framedescB, &frame, framedetails);
+	TraceSpan span ("format", "formatFrame");
+	int frameid = frame.frameid();
+	unsigned long long file_addr = frame.pc();
+	char levelstring[NAME_MAX];
+	if (framedetails&WITH_LEVEL)
+		snprintf (levelstring, sizeof(levelstring), "level=\"%d\",", frameid);
+	else
+		levelstring[0] = '\0';
+
+	const char *func_name="??";
+	static StringB argsstringB(LINE_MAX);
+	argsstringB.clear();
+	if (frame.hasfunction()) {
+		func_name = frame.functionname();
+		const char *filename = frame.filename();
+		const char *filedir = frame.filedirectory();
+		int line = frame.line();
+		if (framedetails&WITH_ARGS) {
+			ValueListRef args = frame.arguments();
+			static StringB argsdescB(LINE_MAX);
+			argsdescB.clear();
+			formatVariables (argsdescB, *args);
+			argsstringB.catsprintf ("%sargs=[%s]", (framedetails==JUST_LEVEL_AND_ARGS)?"":",", argsdescB.c_str());
+		}
+		if (framedetails==JUST_LEVEL_AND_ARGS)
+			framedescB.catsprintf ("frame={%s%s}", levelstring, argsstringB.c_str());
+		else
+			framedescB.catsprintf ("frame={%saddr=\"%p\",func=\"%s\"%s,file=\"%s\","
+								"fullname=\"%s/%s\",line=\"%d\"}",
+								levelstring,file_addr,func_name,argsstringB.c_str(),filename,filedir,filename,line);
+	}
+	else {
+		if (framedetails&WITH_ARGS)
+			argsstringB.catsprintf ("%sargs=[]", (framedetails==JUST_LEVEL_AND_ARGS)?"":",");
+		if (framedetails==JUST_LEVEL_AND_ARGS)
+			framedescB.catsprintf ("frame={%s%s}", levelstring, argsstringB.c_str());
+		else {
+			func_name = frame.functionname();
+			framedescB.catsprintf ("frame={%saddr=\"%p\",func=\"%s\"%s,file=\"%s\"}",
+					levelstring, file_addr, func_name, argsstringB.c_str(), frame.modulefilename());
+		}
+	}
+	return framedescB.c_str();
+}
+
+
+// format a thread description into a GDB string
+char *
+formatThreadInfo (StringB &threaddescB, ProcessView &process, int threadindexid)
+{
+	logprintf (LOG_TRACE, "formatThreadInfo (0x%x, 0x%x, %d)\n", &threaddescB, &process, threadindexid);
+	TraceSpan span ("format", "formatThreadInfo");
+	threaddescB.clear();
+	if (!process.isvalid())
+		return threaddescB.c_str();
+	int pid = process.pid();
+	if (process.isstopped()) {
+		int tmin, tmax;
+		if (threadindexid < 0) {
+			tmin = 0;
+			tmax = process.numthreads();
+		}
+		else{
+			tmin = threadindexid;
+			tmax = threadindexid+1;
+		}
+		const char *separator="";
+		for (int ithread=tmin; ithread<tmax; ithread++) {
+			ThreadRef thread = process.threadat (ithread);
+			if (!thread->isvalid())
+				continue;
+			int tid = thread->threadid();
+			threadindexid = thread->indexid();
+			int frames = thread->numframes();
+			if (frames > 0) {
+				FrameRef frame = thread->frameat (0);
+				if (frame->isvalid()) {
+					static StringB framedescB(LINE_MAX);
+					framedescB.clear();
+					formatFrame (framedescB, *frame, WITH_LEVEL_AND_ARGS);
+					threaddescB.catsprintf (
+						"%s{id=\"%d\",target-id=\"Thread 0x%x of process %d\",%s,state=\"stopped\"}",
+						separator, threadindexid, tid, pid, framedescB.c_str());
+				}
+			}
+			separator=",";
+		}
+	}
+	return threaddescB.c_str();
+}
+
+
+// format a record to send to CDT
+// results of commands without sequence number (0^done) are sent without it (^done)
+char *
+formatRecord (StringB &recordB, const char *format, va_list args)
+{
+	recordB.vosprintf (0, format, args);
+	if ((recordB.c_str()[0] == '0') && (recordB.c_str()[1] == '^'))
+		recordB.clear(1,0);
+	return recordB.c_str();
+}
@@ -0,0 +1,83 @@
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#ifdef __APPLE__
+#include <sys/syslimits.h>
+#else
+#include <limits.h>
+#endif
+#include <stdarg.h>
+#include "stringb.h"
+#include "views.h"
+
+/*
+ * Formatting of values, frames and threads into GDB strings
+ * This part does not depend on LLDB. It is built in the lldbmi2core library
+ * with the buffers and the logs, and linked by lldbmi2 and by the benchmarks.
+ */
+
+#define VALUE_MAX (NAME_MAX<<1)
+#define BIG_VALUE_MAX (NAME_MAX<<3)
+#define BIG_LINE_MAX (LINE_MAX<<3)
+
+#define CHANGE_DEPTH_MAX    3		// maximum depth to check variables changed
+#define WALK_DEPTH_MAX      9		// maximum depth to walk variables when searching expressions
+#define ARRAY_MAX         200		// maximum number of children to display. must be a multiple of 8
+#define CHILDREN_MAX      150		// limit of children to examine when walking in them
+#define VAROBJS_MAX      1000		// varobjs holding a value before evicting the out of scope ones
+#define CHILDREN_WINDOW  1000		// children listed by -var-list-children without a range
+
+// static context
+typedef struct {
+	bool istest;
+	int frames_max;
+	int children_max;
+	int walk_depth_max;
+	int change_depth_max;
+	int varobjs_max;
+	int children_window;
+} LIMITS;
+
+typedef enum
+{
+	NO_SUMMARY		= 0x1,
+	FULL_SUMMARY	= 0x2,
+} VariableDetails;
+
+// formats of -var-set-format
+typedef enum
+{
+	FORMAT_NATURAL		= 0,
+	FORMAT_BINARY,
+	FORMAT_OCTAL,
+	FORMAT_DECIMAL,
+	FORMAT_HEXADECIMAL
+} ValueFormat;
+
+typedef enum
+{
+	WITH_LEVEL			= 0x1,
+	WITH_ARGS			= 0x2,
+	WITH_LEVEL_AND_ARGS	= 0x3,
+	JUST_LEVEL_AND_ARGS	= 0x7
+} FrameDetails;
+
+char *strfind (char *string, const char *find, int way=1, const char *except=NULL);
+char *strup (char *string, int len);
+const char *getName (ValueView &var);
+
+char * formatExpressionPath (StringB &expressionpathdescB, ValueView &var);
+char * formatChildrenList (StringB &childrendescB, ValueView &var, char *expression, int threadindexid, int &varnumchildren);
+char * formatChangedList (StringB &changedescB, ValueView &var, bool &separatorvisible, int depth);
+char * formatVariables (StringB &varsdescB, ValueListView &varslist);
+char * formatVariables (StringB &varsdescB, ValueListView &varslist, int printvalues, bool witharguments);
+char * formatSummary (StringB &summarydescB, ValueView &var);
+char * formatValue (StringB &vardescB, ValueView &var, VariableDetails details);
+ValueFormat scanValueFormat (const char *format);
+char * formatRawValue (StringB &vardescB, const unsigned char *bytes, int size, ValueFormat format);
+char * formatFrame (StringB &framedescB, FrameView &frame, FrameDetails details);
+char * formatThreadInfo (StringB &threaddescB, ProcessView &process, int threadindexid);
+char * formatRecord (StringB &recordB, const char *format, va_list args);
+
+#endif // FORMAT_H
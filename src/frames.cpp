@@ -1,6 +1,9 @@
 
 #include "lldbmi2.h"
 #include "log.h"
+#include "trace.h"
+#include "sbstats.h"
+#include "sbviews.h"
 #include "frames.h"
 #include "variables.h"
 #include "names.h"
@@ -12,7 +15,7 @@ int
 getNumFrames (SBThread thread)
 {
 	logprintf (LOG_TRACE, "getNumFrames(0x%x)\n", &thread);
-	int numframes=thread.GetNumFrames();
+	int numframes = SBCALL (SBThread_GetNumFrames, thread.GetNumFrames());
 	logprintf (LOG_DEBUG, "getNumFrames(0x%x) = %d\n", &thread, numframes);
 	return numframes;
 }
@@ -77,63 +80,8 @@ formatFrame (SBFrame frame, FrameDetails framedetails)
 char *
 formatFrame (StringB &framedescB, SBFrame frame, FrameDetails framedetails)
 {
-	logprintf (LOG_TRACE, "formatFrame (0x%x, 0x%x, 0x%x)\n", &framedescB, &frame, framedetails);
-	int frameid = frame.GetFrameID();
-	SBAddress addr = frame.GetPCAddress();
-	addr_t file_addr = frame.GetPC();
-	SBFunction function = frame.GetFunction();
-	char levelstring[NAME_MAX];
-	if (framedetails&WITH_LEVEL)
-		snprintf (levelstring, sizeof(levelstring), "level=\"%d\",", frameid);
-	else
-		levelstring[0] = '\0';
-
-	const char *modulefilename = "";
-	SBModule module = frame.GetModule();
-	if (module.IsValid()) {
-		SBFileSpec modulefilespec = module.GetPlatformFileSpec();
-		modulefilename = modulefilespec.GetFilename();
-	}
-
-	const char *func_name="??";
-	static StringB argsstringB(LINE_MAX);
-	argsstringB.clear();
-	if (function.IsValid()) {
-		const char *filename, *filedir;
-		int line = 0;
-		func_name = function.GetName();
-		SBLineEntry line_entry = addr.GetLineEntry();
-		SBFileSpec filespec = line_entry.GetFileSpec();
-		filename = filespec.GetFilename();
-		filedir = filespec.GetDirectory();
-		line = line_entry.GetLine();
-		if (framedetails&WITH_ARGS) {
-			SBValueList args = frame.GetVariables(1,0,0,0);
-			static StringB argsdescB(LINE_MAX);
-			argsdescB.clear();
-			SBFunction function = frame.GetFunction();
-			formatVariables (argsdescB, args);
-			argsstringB.catsprintf ("%sargs=[%s]", (framedetails==JUST_LEVEL_AND_ARGS)?"":",", argsdescB.c_str());
-		}
-		if (framedetails==JUST_LEVEL_AND_ARGS)
-			framedescB.catsprintf ("frame={%s%s}", levelstring, argsstringB.c_str());
-		else
-			framedescB.catsprintf ("frame={%saddr=\"%p\",func=\"%s\"%s,file=\"%s\","
-								"fullname=\"%s/%s\",line=\"%d\"}",
-								levelstring,file_addr,func_name,argsstringB.c_str(),filename,filedir,filename,line);
-	}
-	else {
-		if (framedetails&WITH_ARGS)
-			argsstringB.catsprintf ("%sargs=[]", (framedetails==JUST_LEVEL_AND_ARGS)?"":",");
-		if (framedetails==JUST_LEVEL_AND_ARGS)
-			framedescB.catsprintf ("frame={%s%s}", levelstring, argsstringB.c_str());
-		else {
-			func_name = frame.GetFunctionName();
-			framedescB.catsprintf ("frame={%saddr=\"%p\",func=\"%s\"%s,file=\"%s\"}",
-					levelstring, file_addr, func_name, argsstringB.c_str(), modulefilename);
-		}
-	}
-	return framedescB.c_str();
+	SBFrameView frameview (frame);
+	return formatFrame (framedescB, frameview, framedetails);
 }
 
 
@@ -149,48 +97,6 @@ formatThreadInfo (SBProcess process, int threadindexid)
 char *
 formatThreadInfo (StringB &threaddescB, SBProcess process, int threadindexid)
 {
-	logprintf (LOG_TRACE, "formatThreadInfo (0x%x, 0x%x, %d)\n", &threaddescB, &process, threadindexid);
-	threaddescB.clear();
-	if (!process.IsValid())
-		return threaddescB.c_str();
-	int pid=process.GetProcessID();
-	int state = process.GetState ();
-	if (state == eStateStopped) {
-		int tmin, tmax;
-		bool useindexid;
-		if (threadindexid < 0) {
-			tmin = 0;
-			tmax = process.GetNumThreads();
-			useindexid = false;
-		}
-		else{
-			tmin = threadindexid;
-			tmax = threadindexid+1;
-			useindexid = false;
-		}
-		const char *separator="";
-		for (int ithread=tmin; ithread<tmax; ithread++) {
-			SBThread thread;
-			if (useindexid)
-				thread = process.GetThreadByIndexID(ithread);
-			else
-				thread = process.GetThreadAtIndex(ithread);
-			if (!thread.IsValid())
-				continue;
-			int tid=thread.GetThreadID();
-			threadindexid=thread.GetIndexID();
-			int frames = getNumFrames (thread);
-			if (frames > 0) {
-				SBFrame frame = thread.GetFrameAtIndex(0);
-				if (frame.IsValid()) {
-					char * framedescstr = formatFrame (frame, WITH_LEVEL_AND_ARGS);
-					threaddescB.catsprintf (
-						"%s{id=\"%d\",target-id=\"Thread 0x%x of process %d\",%s,state=\"stopped\"}",
-						separator, threadindexid, tid, pid, framedescstr);
-				}
-			}
-			separator=",";
-		}
-	}
-	return threaddescB.c_str();
+	SBProcessView processview (process);
+	return formatThreadInfo (threaddescB, processview, threadindexid);
 }
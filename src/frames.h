@@ -2,14 +2,7 @@
 #ifndef FRAMES_H
 #define FRAMES_H
 
-typedef enum
-{
-	WITH_LEVEL			= 0x1,
-	WITH_ARGS			= 0x2,
-	WITH_LEVEL_AND_ARGS	= 0x3,
-	JUST_LEVEL_AND_ARGS	= 0x7
-} FrameDetails;
-
+#include "format.h"
 
 int    getNumFrames     (SBThread thread);
 void   selectValidFrame (SBThread thread);
@@ -0,0 +1,189 @@
+
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <algorithm>
+
+#include "strlxxx.h"
+#include "latency.h"
+#include "trace.h"
+#include "log.h"
+
+typedef enum {
+	STEP_IDLE,				// no step yet or step completed
+	STEP_RESUMED,			// resume command received
+	STEP_RECEIVED,			// eStateStopped received
+	STEP_EMITTED			// *stopped written. counting follow-up commands
+} StepPhase;
+
+typedef struct {
+	unsigned long long lldb;			// nanoseconds
+	unsigned long long format;
+	unsigned long long followup;
+	int followupcommands;
+} STEPSAMPLE;
+
+static const char *resumecommands[] = {
+	"-exec-run", "-exec-continue", "-exec-step", "-exec-next", "-exec-step-instruction",
+	"-exec-next-instruction", "-exec-finish", "-exec-until", NULL
+};
+
+static bool steplatency_enabled = false;
+static pthread_mutex_t steplatency_mutex = PTHREAD_MUTEX_INITIALIZER;
+static StepPhase stepphase = STEP_IDLE;
+static char stepcommand[32];
+static unsigned long long stepresumed, stepreceived, stepemitted;
+static STEPSAMPLE stepcurrent;
+static STEPSAMPLE stepsamples[STEP_SAMPLES];
+static int stepsamplescount = 0;			// total number of completed steps
+
+
+void
+setsteplatency (bool enable)
+{
+	steplatency_enabled = enable;
+}
+
+bool
+issteplatency ()
+{
+	return steplatency_enabled;
+}
+
+void
+resetsteplatency ()
+{
+	pthread_mutex_lock (&steplatency_mutex);
+	stepsamplescount = 0;
+	stepphase = STEP_IDLE;
+	pthread_mutex_unlock (&steplatency_mutex);
+}
+
+// store the current step in the rolling window. mutex must be locked
+static void
+completestep ()
+{
+	stepsamples[stepsamplescount%STEP_SAMPLES] = stepcurrent;
+	++stepsamplescount;
+	logprintf (LOG_INFO, "step latency %s: lldb=%llu.%03llums, format=%llu.%03llums, followup=%llu.%03llums (%d commands)\n",
+			stepcommand, stepcurrent.lldb/1000000, (stepcurrent.lldb/1000)%1000,
+			stepcurrent.format/1000000, (stepcurrent.format/1000)%1000,
+			stepcurrent.followup/1000000, (stepcurrent.followup/1000)%1000, stepcurrent.followupcommands);
+	stepphase = STEP_IDLE;
+}
+
+// start a step if command resumes the process. return true if so
+bool
+steplatencyresume (const char *command)
+{
+	if (!steplatency_enabled)
+		return false;
+	int icommand;
+	for (icommand=0; resumecommands[icommand]!=NULL; icommand++)
+		if (strcmp(command,resumecommands[icommand]) == 0)
+			break;
+	if (resumecommands[icommand] == NULL)
+		return false;
+	pthread_mutex_lock (&steplatency_mutex);
+	if (stepphase == STEP_EMITTED)			// the previous step is done with its follow-up
+		completestep ();
+	memset (&stepcurrent, 0, sizeof(stepcurrent));
+	strlcpy (stepcommand, command, sizeof(stepcommand));
+	stepresumed = tracenow();
+	stepphase = STEP_RESUMED;
+	pthread_mutex_unlock (&steplatency_mutex);
+	return true;
+}
+
+// eStateStopped received by the listener
+void
+steplatencystopreceived ()
+{
+	if (!steplatency_enabled)
+		return;
+	pthread_mutex_lock (&steplatency_mutex);
+	if (stepphase==STEP_RESUMED || stepphase==STEP_RECEIVED) {	// a previous stop wrote no *stopped
+		stepreceived = tracenow();
+		stepcurrent.lldb = stepreceived - stepresumed;
+		stepphase = STEP_RECEIVED;
+		tracecomplete ("step", "lldb", stepresumed, stepreceived);
+	}
+	pthread_mutex_unlock (&steplatency_mutex);
+}
+
+// *stopped written to CDT
+void
+steplatencystopemitted ()
+{
+	if (!steplatency_enabled)
+		return;
+	pthread_mutex_lock (&steplatency_mutex);
+	if (stepphase == STEP_RECEIVED) {
+		stepemitted = tracenow();
+		stepcurrent.format = stepemitted - stepreceived;
+		stepphase = STEP_EMITTED;
+		tracecomplete ("step", "format", stepreceived, stepemitted);
+	}
+	pthread_mutex_unlock (&steplatency_mutex);
+}
+
+// a command started at start has completed
+void
+steplatencyfollowup (unsigned long long start)
+{
+	if (!steplatency_enabled)
+		return;
+	pthread_mutex_lock (&steplatency_mutex);
+	if (stepphase == STEP_EMITTED) {
+		stepcurrent.followup += tracenow() - start;
+		++stepcurrent.followupcommands;
+	}
+	pthread_mutex_unlock (&steplatency_mutex);
+}
+
+// format min, avg, p50, p95 and max of a series in milliseconds
+static void
+formatseries (StringB &latencydescB, const char *name, unsigned long long *values, int count)
+{
+	std::sort (values, values+count);
+	unsigned long long sum = 0;
+	for (int ivalue=0; ivalue<count; ivalue++)
+		sum += values[ivalue];
+	unsigned long long stats[5] = {0,0,0,0,0};
+	if (count > 0) {
+		stats[0] = values[0];
+		stats[1] = sum/count;
+		stats[2] = values[(count-1)*50/100];
+		stats[3] = values[(count-1)*95/100];
+		stats[4] = values[count-1];
+	}
+	static const char *statnames[] = { "min", "avg", "p50", "p95", "max" };
+	latencydescB.catsprintf (",%s={", name);
+	for (int istat=0; istat<5; istat++)
+		latencydescB.catsprintf ("%s%s=\"%llu.%03llu\"", istat>0? ",": "",
+				statnames[istat], stats[istat]/1000000, (stats[istat]/1000)%1000);
+	latencydescB.append ("}");
+}
+
+// format the statistics of the completed steps in the window
+// steps="12",window="12",lldb={min="1.020",avg=...},format={...},followup={...},total={...}
+char *
+formatStepLatency (StringB &latencydescB)
+{
+	unsigned long long lldb[STEP_SAMPLES], format[STEP_SAMPLES], followup[STEP_SAMPLES], total[STEP_SAMPLES];
+	pthread_mutex_lock (&steplatency_mutex);
+	int count = std::min (stepsamplescount, STEP_SAMPLES);
+	for (int isample=0; isample<count; isample++) {
+		lldb[isample] = stepsamples[isample].lldb;
+		format[isample] = stepsamples[isample].format;
+		followup[isample] = stepsamples[isample].followup;
+		total[isample] = lldb[isample] + format[isample] + followup[isample];
+	}
+	latencydescB.catsprintf ("steps=\"%d\",window=\"%d\"", stepsamplescount, count);
+	pthread_mutex_unlock (&steplatency_mutex);
+	formatseries (latencydescB, "lldb", lldb, count);
+	formatseries (latencydescB, "format", format, count);
+	formatseries (latencydescB, "followup", followup, count);
+	formatseries (latencydescB, "total", total, count);
+	return latencydescB.c_str();
+}
@@ -0,0 +1,25 @@
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "stringb.h"
+
+// End-to-end step latency.
+// A step starts with a resume command (-exec-next, -exec-continue...) and is split in
+//   lldb:     resume command received -> eStateStopped received by the listener
+//   format:   eStateStopped received  -> *stopped written
+//   followup: MI commands executed after *stopped until the next resume (locals, frames, var-update...)
+// Completed steps are kept in a rolling window, logged, and reported by -lldbmi2-step-stats.
+
+#define STEP_SAMPLES 128
+
+void  setsteplatency          (bool enable);
+bool  issteplatency           ();
+void  resetsteplatency        ();
+bool  steplatencyresume       (const char *command);
+void  steplatencystopreceived ();
+void  steplatencystopemitted  ();
+void  steplatencyfollowup     (unsigned long long start);
+char *formatStepLatency       (StringB &latencydescB);
+
+#endif // LATENCY_H
@@ -27,6 +27,9 @@
 #include "engine.h"
 #include "variables.h"
 #include "log.h"
+#include "trace.h"
+#include "sbstats.h"
+#include "latency.h"
 #include "test.h"
 #include "version.h"
 
@@ -50,6 +53,8 @@ void help (STATE *pstate)
 	fprintf (stderr, "Options:\n");
 	fprintf (stderr, "   --log:                Create log file in project root directory.\n");
 	fprintf (stderr, "   --logmask mask:       Select log categories. 0xFFF. See source code for values.\n");
+	fprintf (stderr, "   --trace file_path:    Write a Chrome/Perfetto trace of commands and events.\n");
+	fprintf (stderr, "   --stats:              Count SB API calls per MI command and step latency.\n");
 	fprintf (stderr, "   --arch arch_name:     Force a different architecture from host architecture: arm64, x86_64, i386\n");
 	fprintf (stderr, "   --test n:             Execute test sequence (to debug lldmi2).\n");
 	fprintf (stderr, "   --script file_path:   Execute test script or replay logfile (to debug lldmi2).\n");
@@ -58,6 +63,9 @@ void help (STATE *pstate)
 	fprintf (stderr, "   --children children:  Max number of children to check for update (%d).\n", CHILDREN_MAX);
 	fprintf (stderr, "   --walkdepth depth:    Max walk depth in search for variables (%d).\n", WALK_DEPTH_MAX);
 	fprintf (stderr, "   --changedepth depth:  Max depth to check for updated variables (%d).\n", CHANGE_DEPTH_MAX);
+	fprintf (stderr, "   --varobjs varobjs:    Max number of varobjs before evicting out of scope ones (%d).\n", VAROBJS_MAX);
+	fprintf (stderr, "   --dynamic policy:     Dynamic types: no-dynamic, dynamic-dont-run-target (default), dynamic-can-run-target.\n");
+	fprintf (stderr, "   --window children:    Children listed by -var-list-children without range (%d).\n", CHILDREN_WINDOW);
 }
 
 
@@ -75,6 +83,8 @@ main (int argc, char **argv, char **envp)
 	const char *testCommand=NULL;
 	int  isLog=0;
 	unsigned int logmask=LOG_DEV;
+	char tracefilename[PATH_MAX];
+	tracefilename[0] = '\0';
 
 	state.ptyfd = EOF;
 	state.cdtptyfd = EOF;
@@ -86,6 +96,8 @@ main (int argc, char **argv, char **envp)
 	limits.children_max = CHILDREN_MAX;
 	limits.walk_depth_max = WALK_DEPTH_MAX;
 	limits.change_depth_max = CHANGE_DEPTH_MAX;
+	limits.varobjs_max = VAROBJS_MAX;
+	limits.children_window = CHILDREN_WINDOW;
 
 	// create a log filename from program name and open log file
 	if (true) {
@@ -133,6 +145,16 @@ main (int argc, char **argv, char **envp)
 			if (++narg<argc)
 				sscanf (logarg(argv[narg]), "%x", &logmask);
 		}
+		else if (strcmp (argv[narg],"--trace") == 0 ) {
+			if (++narg<argc)
+				strlcpy (tracefilename, logarg(argv[narg]), sizeof(tracefilename));
+			setsbstats (true);
+			setsteplatency (true);
+		}
+		else if (strcmp (argv[narg],"--stats") == 0 ) {
+			setsbstats (true);
+			setsteplatency (true);
+		}
 		else if (strcmp (argv[narg],"--frames") == 0 ) {
 			if (++narg<argc)
 				sscanf (logarg(argv[narg]), "%d", &limits.frames_max);
@@ -149,6 +171,18 @@ main (int argc, char **argv, char **envp)
 			if (++narg<argc)
 				sscanf (logarg(argv[narg]), "%d", &limits.change_depth_max);
 		}
+		else if (strcmp (argv[narg],"--varobjs") == 0 ) {
+			if (++narg<argc)
+				sscanf (logarg(argv[narg]), "%d", &limits.varobjs_max);
+		}
+		else if (strcmp (argv[narg],"--dynamic") == 0 ) {
+			if (++narg<argc)
+				setDynamicPolicy (scanDynamicPolicy (logarg(argv[narg])));
+		}
+		else if (strcmp (argv[narg],"--window") == 0 ) {
+			if (++narg<argc)
+				sscanf (logarg(argv[narg]), "%d", &limits.children_window);
+		}
 		else if (strcmp (argv[narg],"-ex") == 0) {
 			if (++narg<argc) {
 				if (strncmp(argv[narg], "new-ui", strlen("new-ui")) == 0) {
@@ -184,6 +218,12 @@ main (int argc, char **argv, char **envp)
 	addlog("\n");
 	logprintf (LOG_ARGS, NULL);
 
+	if (tracefilename[0]) {
+		if (opentracefile (tracefilename) < 0)
+			logprintf (LOG_ERROR, "can not open trace file %s\n", tracefilename);
+		tracethread ("main");
+	}
+
 	state.envp[0] = NULL;
 	state.envpentries = 0;
 	state.envspointer = state.envs;
@@ -342,6 +382,7 @@ main (int argc, char **argv, char **envp)
 	terminateSB ();
 
 	logprintf (LOG_INFO, "main exit\n");
+	closetracefile ();
 	closelogfile ();
 
 	return EXIT_SUCCESS;
@@ -359,6 +400,7 @@ void
 writetocdt (const char *line)
 {
 	logprintf (LOG_TRACE, "writetocdt '%s'\n", line);
+	TraceSpan span ("output", "writetocdt");
 	logdata (LOG_CDT_OUT, line, strlen(line));
 	writelog (state.cdtptyfd > 0 ? state.cdtptyfd : STDOUT_FILENO, line, strlen(line));
 }
@@ -372,10 +414,8 @@ cdtprintf ( const char *format, ... )
 
 	if (format!=NULL) {
 		va_start (args, format);
-		buffer.vosprintf (0, format, args);
+		formatRecord (buffer, format, args);
 		va_end (args);
-		if ((buffer.c_str()[0] == '0') && (buffer.c_str()[1] == '^'))
-			buffer.clear(1,0);
 		writetocdt (buffer.c_str());
 	}
 }
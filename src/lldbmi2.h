@@ -29,6 +29,8 @@ using namespace lldb;
 #include "strlxxx.h"
 #endif
 #include "stringb.h"
+#include "format.h"
+#include "varobjs.h"
 
 #include <map>
 
@@ -41,21 +43,8 @@ using namespace lldb;
 #define THREADS_MAX 50
 #define FRAMES_MAX  75
 
-#define VALUE_MAX (NAME_MAX<<1)
-#define BIG_VALUE_MAX (NAME_MAX<<3)
-#define BIG_LINE_MAX (LINE_MAX<<3)
-
 #define ENV_ENTRIES 200
 
-// static context
-typedef struct {
-	bool istest;
-	int frames_max;
-	int children_max;
-	int walk_depth_max;
-	int change_depth_max;
-} LIMITS;
-
 
 // dynamic context
 typedef struct {
@@ -82,8 +71,7 @@ typedef struct {
 	SBDebugger debugger;
 	SBProcess process;
 	SBListener listener;
-	std::map<std::string, SBValue> sessionVariables;
-	int nextSessionVariableId = 1; // for `varNNNNNN` generated names
+	VarobjTable varobjs;
 	int threadids[THREADS_MAX];
 } STATE;
 
@@ -0,0 +1,32 @@
+
+#ifndef PROBES_H
+#define PROBES_H
+
+// USDT static probes, provider lldbmi2.
+// Compiled to a single nop per probe when sys/sdt.h is available (HAVE_SYS_SDT_H set by CMake),
+// and to nothing otherwise. List them with:
+//   readelf -n lldbmi2 | grep -A2 stapsdt
+// Use them with:
+//   bpftrace -e 'usdt:./lldbmi2:lldbmi2:command_begin { @start[arg0] = nsecs; }
+//                usdt:./lldbmi2:lldbmi2:command_end   { @us[str(arg1)] = hist((nsecs-@start[arg0])/1000); }'
+//   perf probe -x lldbmi2 sdt_lldbmi2:command_begin
+//
+// Probes and arguments:
+//   command_begin             sequence, command name
+//   command_end               sequence, command name
+//   stop_event_received       process state
+//   stopped_emitted           stop reason
+//   inferior_output_forwarded bytes
+//   varobj_created            varobj name, expression
+//   varobj_updated            varobj name, changelist length
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define PROBE1(name,a1)       DTRACE_PROBE1(lldbmi2, name, a1)
+#define PROBE2(name,a1,a2)    DTRACE_PROBE2(lldbmi2, name, a1, a2)
+#else
+#define PROBE1(name,a1)       do {} while (0)
+#define PROBE2(name,a1,a2)    do {} while (0)
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,116 @@
+
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <atomic>
+#include <map>
+#include <string>
+
+#include "sbstats.h"
+#include "trace.h"
+
+// counters of one MI command
+typedef struct {
+	unsigned long commands;
+	unsigned long calls[SB_METHODS_COUNT];
+	unsigned long long time[SB_METHODS_COUNT];		// nanoseconds
+} SBCOUNTERS;
+
+#define SB_METHOD_NAME(sbclass,method) #sbclass "::" #method,
+static const char *sbmethodnames[] = {
+	SB_METHODS(SB_METHOD_NAME)
+	NULL
+};
+#undef SB_METHOD_NAME
+
+static std::atomic<bool> sbstats_enabled (false);
+static std::map<std::string, SBCOUNTERS> sbcounters;
+static pthread_mutex_t sbstats_mutex = PTHREAD_MUTEX_INITIALIZER;
+// counters of the command executing on this thread
+static __thread SBCOUNTERS *sbcurrent = NULL;
+
+
+void
+setsbstats (bool enable)
+{
+	sbstats_enabled = enable;
+}
+
+bool
+issbstats ()
+{
+	return sbstats_enabled;
+}
+
+// forget all counters. commands in progress restart from zero
+void
+resetsbstats ()
+{
+	pthread_mutex_lock (&sbstats_mutex);
+	for (auto &entry : sbcounters)
+		memset (&entry.second, 0, sizeof(SBCOUNTERS));
+	pthread_mutex_unlock (&sbstats_mutex);
+}
+
+// attribute next calls on this thread to command
+void
+setsbcommand (const char *command)
+{
+	if (!sbstats_enabled)
+		return;
+	pthread_mutex_lock (&sbstats_mutex);
+	auto found = sbcounters.find (command);
+	if (found == sbcounters.end()) {
+		SBCOUNTERS counters;
+		memset (&counters, 0, sizeof(counters));
+		found = sbcounters.insert (std::make_pair(std::string(command), counters)).first;
+	}
+	sbcurrent = &found->second;		// map nodes are never moved
+	++sbcurrent->commands;
+	pthread_mutex_unlock (&sbstats_mutex);
+}
+
+// count a call started at start if accounting is enabled, and trace it if tracing
+void
+countsbcall (SBMethod method, unsigned long long start, const char *detail)
+{
+	unsigned long long end = tracenow();
+	if (sbcurrent==NULL && sbstats_enabled)
+		setsbcommand ("(none)");
+	if (sbcurrent!=NULL && sbstats_enabled) {		// accounting may be disabled during the call
+		pthread_mutex_lock (&sbstats_mutex);		// counters are read and reset by the other thread
+		++sbcurrent->calls[method];
+		sbcurrent->time[method] += end-start;
+		pthread_mutex_unlock (&sbstats_mutex);
+	}
+	tracecomplete ("sb", sbmethodnames[method], start, end, detail);
+}
+
+// format counters as a MI list. time in milliseconds
+// sbstats=[{command="-var-create",count="2",calls=[{method="SBValue::GetType",calls="14",time="0.231"}]}]
+char *
+formatSBStats (StringB &statsdescB)
+{
+	pthread_mutex_lock (&sbstats_mutex);
+	const char *commandseparator = "";
+	for (auto &entry : sbcounters) {
+		SBCOUNTERS &counters = entry.second;
+		if (counters.commands == 0)
+			continue;
+		statsdescB.catsprintf ("%s{command=\"%s\",count=\"%lu\",calls=[",
+				commandseparator, entry.first.c_str(), counters.commands);
+		const char *callseparator = "";
+		for (int method=0; method<SB_METHODS_COUNT; method++) {
+			if (counters.calls[method] == 0)
+				continue;
+			statsdescB.catsprintf ("%s{method=\"%s\",calls=\"%lu\",time=\"%llu.%03llu\"}",
+					callseparator, sbmethodnames[method], counters.calls[method],
+					counters.time[method]/1000000, (counters.time[method]/1000)%1000);
+			callseparator = ",";
+		}
+		statsdescB.append ("]}");
+		commandseparator = ",";
+	}
+	pthread_mutex_unlock (&sbstats_mutex);
+	return statsdescB.c_str();
+}
@@ -0,0 +1,85 @@
+
+#ifndef SBSTATS_H
+#define SBSTATS_H
+
+#include "stringb.h"
+#include "trace.h"
+
+// SB API call accounting.
+// SBCALL(method, call) counts the calls and the cumulative time spent in a SB method.
+// Counts are attributed to the MI command executing on the calling thread
+// and reported by -lldbmi2-stats. Accounting is enabled by --stats or --trace.
+// While tracing, each call is also a span of the trace, whatever the accounting.
+// SBCALL_DETAIL(method, detail, call) shows detail in the span, like an expression.
+
+#define SB_METHODS(M) \
+	M(SBFrame,     GetVariables) \
+	M(SBFrame,     GetValueForVariablePath) \
+	M(SBFrame,     EvaluateExpression) \
+	M(SBFrame,     FindRegister) \
+	M(SBFrame,     GetFunction) \
+	M(SBFrame,     GetLineEntry) \
+	M(SBValueList, GetFirstValueByName) \
+	M(SBValueList, GetValueAtIndex) \
+	M(SBValue,     GetName) \
+	M(SBValue,     GetValue) \
+	M(SBValue,     GetSummary) \
+	M(SBValue,     GetType) \
+	M(SBValue,     GetNumChildren) \
+	M(SBValue,     GetChildAtIndex) \
+	M(SBValue,     GetExpressionPath) \
+	M(SBValue,     GetValueDidChange) \
+	M(SBValue,     GetValueAsUnsigned) \
+	M(SBValue,     GetLoadAddress) \
+	M(SBValue,     GetData) \
+	M(SBValue,     GetError) \
+	M(SBValue,     IsInScope) \
+	M(SBType,      GetPointeeType) \
+	M(SBType,      GetTypeClass) \
+	M(SBType,      GetDisplayTypeName) \
+	M(SBThread,    GetNumFrames) \
+	M(SBThread,    GetFrameAtIndex) \
+	M(SBProcess,   GetNumThreads) \
+	M(SBProcess,   GetThreadAtIndex) \
+	M(SBProcess,   ReadMemory) \
+	M(SBTarget,    EvaluateExpression)
+
+#define SB_METHOD_ENUM(sbclass,method) sbclass##_##method,
+typedef enum
+{
+	SB_METHODS(SB_METHOD_ENUM)
+	SB_METHODS_COUNT
+} SBMethod;
+#undef SB_METHOD_ENUM
+
+void  setsbstats     (bool enable);
+bool  issbstats      ();
+void  resetsbstats   ();
+void  setsbcommand   (const char *command);
+void  countsbcall    (SBMethod method, unsigned long long start, const char *detail=NULL);
+char *formatSBStats  (StringB &statsdescB);
+
+// count a call when it returns, including void calls
+class SBCallCounter {
+private:
+	SBMethod method;
+	unsigned long long start;
+	const char *detail;
+public:
+	SBCallCounter (SBMethod m, const char *d) : method(m), start(tracenow()), detail(d) {}
+	~SBCallCounter () { countsbcall (method, start, detail); }
+};
+
+template <typename F>
+inline auto sbcall (SBMethod method, F call, const char *detail=NULL) -> decltype(call())
+{
+	if (!issbstats() && !istracing())
+		return call();
+	SBCallCounter counter (method, detail);
+	return call();
+}
+
+#define SBCALL(method, call) sbcall (method, [&]() { return call; })
+#define SBCALL_DETAIL(method, detail, call) sbcall (method, [&]() { return call; }, detail)
+
+#endif // SBSTATS_H
@@ -0,0 +1,278 @@
+
+#include "lldbmi2.h"
+#include "sbstats.h"
+#include "sbviews.h"
+#include "frames.h"
+#include "variables.h"
+
+
+SBType &
+SBValueView::gettype ()
+{
+	if (!hastype) {
+		type = SBCALL (SBValue_GetType, var.GetType());
+		hastype = true;
+	}
+	return type;
+}
+
+bool
+SBValueView::isvalid ()
+{
+	return var.IsValid();
+}
+
+bool
+SBValueView::isfailed ()
+{
+	return SBCALL (SBValue_GetError, var.GetError()).Fail();
+}
+
+const char *
+SBValueView::errorstring ()
+{
+	return var.GetError().GetCString();
+}
+
+const char *
+SBValueView::name ()
+{
+	return SBCALL (SBValue_GetName, var.GetName());
+}
+
+const char *
+SBValueView::value ()
+{
+	return SBCALL (SBValue_GetValue, var.GetValue());
+}
+
+const char *
+SBValueView::summary ()
+{
+	return SBCALL (SBValue_GetSummary, var.GetSummary());
+}
+
+const char *
+SBValueView::displaytypename ()
+{
+	return SBCALL (SBType_GetDisplayTypeName, gettype().GetDisplayTypeName());
+}
+
+int
+SBValueView::typeflags ()
+{
+	SBType &vartype = gettype();
+	int flags = 0;
+	if (vartype.IsPointerType())
+		flags |= VIEW_POINTER;
+	if (vartype.IsReferenceType())
+		flags |= VIEW_REFERENCE;
+	if (vartype.IsArrayType())
+		flags |= VIEW_ARRAY;
+	TypeClass vartypeclass = SBCALL (SBType_GetTypeClass, vartype.GetTypeClass());
+	if (vartypeclass==eTypeClassClass || vartypeclass==eTypeClassStruct || vartypeclass==eTypeClassUnion)
+		flags |= VIEW_AGGREGATE;
+	return flags;
+}
+
+int
+SBValueView::numchildren ()
+{
+	return SBCALL (SBValue_GetNumChildren, var.GetNumChildren());
+}
+
+ValueRef
+SBValueView::childat (int index, bool dynamic)
+{
+	SBValue child;
+	if (dynamic)
+		child = getDynamicChild (var, index);
+	else
+		child = SBCALL (SBValue_GetChildAtIndex, var.GetChildAtIndex(index));
+	return ValueRef (new SBValueView (child));
+}
+
+void
+SBValueView::expressionpath (StringB &pathB)
+{
+	SBStream stream;
+	SBCALL (SBValue_GetExpressionPath, var.GetExpressionPath (stream, true));
+	pathB.append (stream.GetData());
+}
+
+bool
+SBValueView::isinscope ()
+{
+	return SBCALL (SBValue_IsInScope, var.IsInScope());
+}
+
+bool
+SBValueView::isargument ()
+{
+	return var.GetValueType() == eValueTypeVariableArgument;
+}
+
+unsigned long long
+SBValueView::valueasunsigned ()
+{
+	return SBCALL (SBValue_GetValueAsUnsigned, var.GetValueAsUnsigned());
+}
+
+unsigned long long
+SBValueView::loadaddress ()
+{
+	return SBCALL (SBValue_GetLoadAddress, var.GetLoadAddress());
+}
+
+void
+SBValueView::setprefersynthetic ()
+{
+	var.SetPreferSyntheticValue (true);
+}
+
+
+int
+SBValueListView::size ()
+{
+	return list.GetSize();
+}
+
+ValueRef
+SBValueListView::at (int index)
+{
+	return ValueRef (new SBValueView (SBCALL (SBValueList_GetValueAtIndex, list.GetValueAtIndex(index))));
+}
+
+
+bool
+SBFrameView::isvalid ()
+{
+	return frame.IsValid();
+}
+
+int
+SBFrameView::frameid ()
+{
+	return frame.GetFrameID();
+}
+
+unsigned long long
+SBFrameView::pc ()
+{
+	return frame.GetPC();
+}
+
+bool
+SBFrameView::hasfunction ()
+{
+	if (!hasfunctionchecked) {
+		function = SBCALL (SBFrame_GetFunction, frame.GetFunction());
+		if (function.IsValid())
+			lineentry = frame.GetPCAddress().GetLineEntry();
+		hasfunctionchecked = true;
+	}
+	return function.IsValid();
+}
+
+const char *
+SBFrameView::functionname ()
+{
+	if (hasfunction())
+		return function.GetName();
+	return frame.GetFunctionName();
+}
+
+const char *
+SBFrameView::filename ()
+{
+	return lineentry.GetFileSpec().GetFilename();
+}
+
+const char *
+SBFrameView::filedirectory ()
+{
+	return lineentry.GetFileSpec().GetDirectory();
+}
+
+int
+SBFrameView::line ()
+{
+	return lineentry.GetLine();
+}
+
+const char *
+SBFrameView::modulefilename ()
+{
+	SBModule module = frame.GetModule();
+	if (module.IsValid())
+		return module.GetPlatformFileSpec().GetFilename();
+	return "";
+}
+
+ValueListRef
+SBFrameView::arguments ()
+{
+	return ValueListRef (new SBValueListView (SBCALL (SBFrame_GetVariables, frame.GetVariables(1,0,0,0))));
+}
+
+
+bool
+SBThreadView::isvalid ()
+{
+	return thread.IsValid();
+}
+
+int
+SBThreadView::threadid ()
+{
+	return thread.GetThreadID();
+}
+
+int
+SBThreadView::indexid ()
+{
+	return thread.GetIndexID();
+}
+
+int
+SBThreadView::numframes ()
+{
+	return getNumFrames (thread);
+}
+
+FrameRef
+SBThreadView::frameat (int index)
+{
+	return FrameRef (new SBFrameView (SBCALL (SBThread_GetFrameAtIndex, thread.GetFrameAtIndex(index))));
+}
+
+
+bool
+SBProcessView::isvalid ()
+{
+	return process.IsValid();
+}
+
+int
+SBProcessView::pid ()
+{
+	return process.GetProcessID();
+}
+
+bool
+SBProcessView::isstopped ()
+{
+	return process.GetState() == eStateStopped;
+}
+
+int
+SBProcessView::numthreads ()
+{
+	return SBCALL (SBProcess_GetNumThreads, process.GetNumThreads());
+}
+
+ThreadRef
+SBProcessView::threadat (int index)
+{
+	return ThreadRef (new SBThreadView (SBCALL (SBProcess_GetThreadAtIndex, process.GetThreadAtIndex(index))));
+}
@@ -0,0 +1,91 @@
+
+#ifndef SBVIEWS_H
+#define SBVIEWS_H
+
+#include <lldb/API/LLDB.h>
+using namespace lldb;
+
+#include "views.h"
+
+// views of the LLDB SB objects. see views.h
+
+class SBValueView : public ValueView {
+private:
+	SBValue var;
+	SBType type;
+	bool hastype;
+	SBType &gettype ();
+public:
+	SBValueView (SBValue value) : var(value), hastype(false) {}
+	bool        isvalid ();
+	bool        isfailed ();
+	const char *errorstring ();
+	const char *name ();
+	const char *value ();
+	const char *summary ();
+	const char *displaytypename ();
+	int         typeflags ();
+	int         numchildren ();
+	ValueRef    childat (int index, bool dynamic=false);
+	void        expressionpath (StringB &pathB);
+	bool        isinscope ();
+	bool        isargument ();
+	unsigned long long valueasunsigned ();
+	unsigned long long loadaddress ();
+	void        setprefersynthetic ();
+};
+
+class SBValueListView : public ValueListView {
+private:
+	SBValueList list;
+public:
+	SBValueListView (SBValueList valuelist) : list(valuelist) {}
+	int         size ();
+	ValueRef    at (int index);
+};
+
+class SBFrameView : public FrameView {
+private:
+	SBFrame frame;
+	SBFunction function;
+	SBLineEntry lineentry;			// valid after hasfunction() when the frame has a function
+	bool hasfunctionchecked;
+public:
+	SBFrameView (SBFrame sbframe) : frame(sbframe), hasfunctionchecked(false) {}
+	bool        isvalid ();
+	int         frameid ();
+	unsigned long long pc ();
+	bool        hasfunction ();
+	const char *functionname ();
+	const char *filename ();
+	const char *filedirectory ();
+	int         line ();
+	const char *modulefilename ();
+	ValueListRef arguments ();
+};
+
+class SBThreadView : public ThreadView {
+private:
+	SBThread thread;
+public:
+	SBThreadView (SBThread sbthread) : thread(sbthread) {}
+	bool        isvalid ();
+	int         threadid ();
+	int         indexid ();
+	int         numframes ();
+	FrameRef    frameat (int index);
+};
+
+class SBProcessView : public ProcessView {
+private:
+	SBProcess process;
+public:
+	SBProcessView (SBProcess sbprocess) : process(sbprocess) {}
+	bool        isvalid ();
+	int         pid ();
+	bool        isstopped ();
+	int         numthreads ();
+	ThreadRef   threadat (int index);
+};
+
+#endif // SBVIEWS_H
@@ -95,6 +95,8 @@ StringB::append (const char c) {
 	if (buffer_size+1 >= buffer_capacity)
 		if (grow (1) == NULL)
 			return NULL;
+	if (buffer_size+1 >= buffer_capacity)		// BIG_LIMIT reached
+		return buffer_array;
 	buffer_array[buffer_size++] = c;
 	buffer_array[buffer_size] = '\0';
 	return buffer_array;
@@ -110,6 +112,8 @@ StringB::copyat (int offset, const char *string, int maxBytes, int extraBytes) {
 	if (offset+string_length >= buffer_capacity)
 		if (grow (string_length+1) == NULL)
 			return NULL;
+	if (offset+string_length >= buffer_capacity)		// BIG_LIMIT reached. truncate
+		maxBytes = string_length = buffer_capacity-offset-1;
 	if (maxBytes<=string_length)
 		::strlcpy (buffer_array+offset, string, string_length+1);
 	else
@@ -149,6 +153,8 @@ StringB::vosprintf (int offset, const char *format, va_list args)
     	else {
     		string_length = vsnprintf (buffer_array+offset, buffer_capacity-offset, format, args_start);
     	}
+    	if (string_length > buffer_capacity-offset-1)	// BIG_LIMIT reached. truncated
+    		string_length = buffer_capacity-offset-1;
     }
 	buffer_size = offset+string_length;
     return string_length;
@@ -87,8 +87,17 @@ const char *testcommands_UPDATE[] = {
 	"62-exec-run --thread-group i1",
 	"41-stack-list-locals --thread 1 --frame 0 1",
 	"42-stack-info-depth --thread 1 11",
+	"43-stack-list-locals --thread 1 --frame 0 --simple-values",
+	"44-stack-list-variables --thread 1 --frame 0 --no-values",
+	"45-stack-list-variables --thread 1 --frame 0 --changed-since 1",	// ^error, locals only
+	"46-stack-list-locals --thread 1 --frame 0 5",						// ^error, print-values is 0 to 2
+	"47-stack-list-locals --thread 1 --frame 0 --changed-since last 1",	// ^error, a stop generation is a number
 	"37-var-create --thread 1 --frame 0 - * py",
 	"38-var-list-children py",
+	"39-var-list-children --all-values py 0 1",
+	"40-var-create watch @ py",
+	"41-var-create count @ c",
+	"42-var-set-format count hexadecimal",
 	"55-var-create --thread 1 --frame 0 - * py->s[0]",
 	"56-var-info-path-expression py->m",
 	"57-var-evaluate-expression py->m",
@@ -96,7 +105,28 @@ const char *testcommands_UPDATE[] = {
 	"41-stack-list-locals --thread 1 --frame 0 1",
 	"42-stack-info-depth --thread 1 11",
 	"45-var-update 1 py",
+	"46-var-evaluate-expression count",									// ^done,value="0x0000000c" at the new stop
+	"47-lldbmi2-stats on",
+	"48-lldbmi2-stats reset",
+	"49-var-list-children py",
+	"50-lldbmi2-stats",		// SBValue::GetChildAtIndex, GetName, GetType and GetNumChildren once per child
+	"51-lldbmi2-stats reset",
+	"52-var-list-children py",
+	"53-lldbmi2-stats",		// second listing at this stop: none of them for the children
+	"54-lldbmi2-stats off",
 	"64-var-create --thread 1 --frame 0 - * strlen(b)",
+	"65-var-list-children var1",
+	"68-var-set-frozen var1 1",
+	"69-var-update 1 *",
+	"70-var-set-frozen var1 0",
+	"66-var-delete -c var1",
+	"67-var-delete var1",
+	"71-exec-step --thread 1 1",											// into sub()
+	"72-var-create --thread 1 --frame 0 - * y.m",							// global, not bound to sub()
+	"73-var-create --thread 1 --frame 0 - * d",								// local of sub()
+	"74-exec-finish --thread 1 --frame 0",
+	"75-var-update 1 *",		// ^done,changelist=[{name="var5",in_scope="false",type_changed="false",has_more="0"}]. var4 in scope
+	"76-var-evaluate-expression var4",
 	"80-gdb-exit",
 	NULL
 };
@@ -403,6 +433,26 @@ const char *testcommands_LONG_INHERITANCE[] = {
 	NULL
 };
 
+const char *testcommands_BITFIELD[] = {
+	"31-environment-cd %s/tests",
+	"32-file-exec-and-symbols --thread-group i1 %s/build/tests",
+	"33-gdb-set --thread-group i1 args %s",
+	"34-inferior-tty-set --thread-group i1 %s",
+	"35-break-insert --thread-group i1 %s/tests/src/tests.cpp:405",		// breakpoint 1 in test_BITFIELD()
+	"36-exec-run --thread-group i1",
+	"40-var-create --thread 1 --frame 0 - * bits",
+	"41-var-list-children var1",
+	"42-var-evaluate-expression var1.high",
+	"43-var-evaluate-expression var1.low",
+	"44-var-update 1 *",							// natural format: ^done,changelist=[], low and high not shared
+	"43-var-set-format var1.high hexadecimal",		// ^done,format="hexadecimal",value="0x11", not the storage unit of low and high
+	"44-var-set-format var1.low binary",			// ^done,format="binary",value="0b101"
+	"45-var-set-format var1.sign decimal",			// ^done,format="decimal",value="-3"
+	"46-var-update 1 var1",							// ^done,changelist=[]
+	"80-gdb-exit",
+	NULL
+};
+
 #endif // WITH_TESTS
 
 #ifdef WITH_LO_TESTS
@@ -461,6 +511,7 @@ getTestCommands (int test_sequence)
 	case 14:    return testcommands_OTHER;
 	case 15:    return testcommands_BIG_CLASS;
 	case 16:    return testcommands_LONG_INHERITANCE;
+	case 17:    return testcommands_BITFIELD;
 #endif // WITH_TESTS
 #ifdef WITH_LO_TESTS
 	case 31:    return testcommands_LO;
@@ -0,0 +1,218 @@
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+#include "stringb.h"
+
+static int     trace_fd=-1;
+static int     trace_pid=0;
+static int     trace_lasttid=0;
+static unsigned long long trace_start=0;
+static StringB tracebuffer;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread int trace_tid=0;
+
+// trace events are written as a JSON array, one event per line
+// the array is closed by closetracefile. chrome://tracing and perfetto
+// also accept a truncated array if lldbmi2 did not exit cleanly
+
+
+// return monotonic time in nanoseconds
+unsigned long long
+tracenow ()
+{
+	timespec tp;
+	clock_gettime (CLOCK_MONOTONIC, &tp);
+	return (unsigned long long)tp.tv_sec*1000000000ULL + tp.tv_nsec;
+}
+
+// small sequential thread ids are easier to read than pthread ids
+static int
+gettracetid ()
+{
+	if (trace_tid == 0)
+		trace_tid = __sync_add_and_fetch (&trace_lasttid, 1);
+	return trace_tid;
+}
+
+// append a string with JSON escapes
+static void
+appendjson (StringB &buffer, const char *string)
+{
+	for (const char *ps=string; *ps; ps++) {
+		if (*ps=='"' || *ps=='\\') {
+			buffer.append ('\\');
+			buffer.append (*ps);
+		}
+		else if ((unsigned char)*ps < 0x20)
+			buffer.catsprintf ("\\u%04x", (unsigned char)*ps);
+		else
+			buffer.append (*ps);
+	}
+}
+
+// write an event. buffer must be locked
+static void
+writeevent ()
+{
+	tracebuffer.append (",\n");
+	if (write (trace_fd, tracebuffer.c_str(), tracebuffer.size()) <= 0) {
+		close (trace_fd);
+		trace_fd = -1;
+	}
+}
+
+// format the common part of an event. buffer must be locked
+static void
+startevent (const char *phase, const char *category, const char *name)
+{
+	unsigned long long ts = tracenow() - trace_start;
+	tracebuffer.clear();
+	tracebuffer.append ("{\"name\":\"");
+	appendjson (tracebuffer, name);
+	tracebuffer.catsprintf ("\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%d",
+			category, phase, ts/1000, ts%1000, trace_pid, gettracetid());
+}
+
+// open and truncate the trace file
+int
+opentracefile (const char *tracefilename)
+{
+	umask (S_IWGRP | S_IWOTH);
+	trace_fd = open (tracefilename, O_WRONLY|O_CREAT|O_TRUNC, 0664);
+	if (trace_fd < 0)
+		return trace_fd;
+	trace_pid = getpid();
+	trace_start = tracenow();
+	tracebuffer.grow (LINE_MAX);
+	if (write (trace_fd, "[\n", 2) <= 0) {
+		close (trace_fd);
+		trace_fd = -1;
+	}
+	return trace_fd;
+}
+
+// close the JSON array and the trace file
+void
+closetracefile ()
+{
+	pthread_mutex_lock (&trace_mutex);
+	if (trace_fd >= 0) {
+		tracebuffer.clear();
+		tracebuffer.catsprintf ("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"lldbmi2\"}}\n]\n", trace_pid);
+		ssize_t written = write (trace_fd, tracebuffer.c_str(), tracebuffer.size());
+		(void) written;
+		close (trace_fd);
+		trace_fd = -1;
+	}
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+bool
+istracing ()
+{
+	return trace_fd >= 0;
+}
+
+// name the calling thread in the trace viewer
+void
+tracethread (const char *threadname)
+{
+	if (trace_fd < 0)
+		return;
+	pthread_mutex_lock (&trace_mutex);
+	tracebuffer.clear();
+	tracebuffer.catsprintf ("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+			trace_pid, gettracetid());
+	appendjson (tracebuffer, threadname);
+	tracebuffer.append ("\"}}");
+	writeevent ();
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+// open a span on the calling thread. detail is shown in the span arguments
+void
+tracebegin (const char *category, const char *name, const char *detail)
+{
+	if (trace_fd < 0)
+		return;
+	pthread_mutex_lock (&trace_mutex);
+	startevent ("B", category, name);
+	if (detail != NULL) {
+		tracebuffer.append (",\"args\":{\"detail\":\"");
+		appendjson (tracebuffer, detail);
+		tracebuffer.append ("\"}");
+	}
+	tracebuffer.append ("}");
+	writeevent ();
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+// close the last span opened on the calling thread
+void
+traceend ()
+{
+	if (trace_fd < 0)
+		return;
+	pthread_mutex_lock (&trace_mutex);
+	unsigned long long ts = tracenow() - trace_start;
+	tracebuffer.clear();
+	tracebuffer.catsprintf ("{\"ph\":\"E\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%d}",
+			ts/1000, ts%1000, trace_pid, gettracetid());
+	writeevent ();
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+// record a span already measured with tracenow
+void
+tracecomplete (const char *category, const char *name, unsigned long long start, unsigned long long end, const char *detail)
+{
+	if (trace_fd < 0)
+		return;
+	pthread_mutex_lock (&trace_mutex);
+	unsigned long long ts = start - trace_start;
+	unsigned long long dur = end - start;
+	tracebuffer.clear();
+	tracebuffer.catsprintf ("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"pid\":%d,\"tid\":%d",
+			name, category, ts/1000, ts%1000, dur/1000, dur%1000, trace_pid, gettracetid());
+	if (detail != NULL) {
+		tracebuffer.append (",\"args\":{\"detail\":\"");
+		appendjson (tracebuffer, detail);
+		tracebuffer.append ("\"}");
+	}
+	tracebuffer.append ("}");
+	writeevent ();
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+// record a counter value. counters with the same name are grouped in one track
+void
+tracecounter (const char *name, const char *series, long value)
+{
+	if (trace_fd < 0)
+		return;
+	pthread_mutex_lock (&trace_mutex);
+	startevent ("C", "counter", name);
+	tracebuffer.catsprintf (",\"args\":{\"%s\":%ld}}", series, value);
+	writeevent ();
+	pthread_mutex_unlock (&trace_mutex);
+}
+
+
+TraceSpan::TraceSpan (const char *category, const char *name, const char *detail) {
+	active = trace_fd>=0 && name!=NULL;
+	if (active)
+		tracebegin (category, name, detail);
+}
+
+TraceSpan::~TraceSpan () {
+	if (active)
+		traceend ();
+}
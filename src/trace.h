@@ -0,0 +1,32 @@
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+
+// Chrome/Perfetto trace export.
+// With --trace file.json, spans and counters are written in the Trace Event
+// JSON format. The file loads directly in chrome://tracing or ui.perfetto.dev.
+// When tracing is off, every call returns immediately.
+
+int   opentracefile  (const char *tracefilename);
+void  closetracefile ();
+bool  istracing      ();
+void  tracethread    (const char *threadname);
+void  tracebegin     (const char *category, const char *name, const char *detail=NULL);
+void  traceend       ();
+void  tracecomplete  (const char *category, const char *name, unsigned long long start, unsigned long long end,
+                      const char *detail=NULL);
+void  tracecounter   (const char *name, const char *series, long value);
+unsigned long long tracenow ();		// monotonic time in nanoseconds
+
+// span from construction to end of scope
+class TraceSpan {
+private:
+	bool active;
+public:
+	TraceSpan (const char *category, const char *name, const char *detail=NULL);
+	~TraceSpan ();
+};
+
+#endif // TRACE_H
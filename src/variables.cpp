@@ -1,7 +1,14 @@
 
 #include "lldbmi2.h"
 #include "log.h"
+#include "trace.h"
+#include "sbstats.h"
+#include "sbviews.h"
+#include <atomic>
+#include <map>
+#include <set>
 #include <string>
+#include <tuple>
 #include "variables.h"
 #include "names.h"
 #include <ctype.h>
@@ -9,6 +16,200 @@
 
 extern LIMITS limits;
 
+// variables found during the current stop of the process
+// values are kept, as LLDB updates them. values of expressions are evaluated again
+typedef struct {
+	VariableApproach approach;
+	SBValue var;
+} FOUNDVARIABLE;
+
+// variables of a frame with the index of their names
+typedef struct {
+	SBValueList varslist;
+	std::map<std::string, int> indexes;
+} FRAMEVARIABLES;
+
+// dynamic types of values, with the count of children fetched with a policy and
+// of those which got a dynamic type
+static DynamicValueType dynamicpolicy = eDynamicDontRunTarget;
+static unsigned long long dynamicrequests = 0;
+static unsigned long long dynamicvalues = 0;
+
+// locals of a frame at their last listing, to list those which changed since a stop
+typedef struct {
+	bool scalar;
+	unsigned long long hash;			// raw bytes of scalars
+	std::string value;					// formatted value of others
+	int changed;						// stop generation of the last change
+	int seen;							// stop generation of the last listing
+} LOCALSNAPSHOT;
+
+typedef struct {
+	int listed;
+	std::map<std::pair<std::string, int>, LOCALSNAPSHOT> locals;	// by name and occurrence of the name
+} FRAMELOCALS;
+
+// by thread index id, cfa and function, kept across stops for the FRAMES_MAX last listed frames
+static std::map<std::tuple<int, unsigned long long, std::string>, FRAMELOCALS> framelocals;
+
+typedef std::pair<int, int> FRAMEKEY;										// thread index id, frame id
+static std::atomic<int> stopgeneration (0);							// counted by the listener thread
+static int foundgeneration = 0;										// stop of the variables found. main thread only
+static std::map<std::tuple<int, int, std::string>, FOUNDVARIABLE> foundvariables;
+static std::map<FRAMEKEY, FRAMEVARIABLES> framevariables;
+
+// names of the dynamic type policies, from -gdb-set lldbmi2-dynamic
+static const char *dynamicpolicynames[] = { "no-dynamic", "dynamic-can-run-target", "dynamic-dont-run-target" };
+
+// set how values get their dynamic type
+// no-dynamic: static types. dynamic-dont-run-target: from the program memory. dynamic-can-run-target: may run the program
+void
+setDynamicPolicy (DynamicValueType policy)
+{
+	logprintf (LOG_TRACE, "setDynamicPolicy (%s)\n", dynamicpolicynames[policy]);
+	dynamicpolicy = policy;
+}
+
+DynamicValueType
+getDynamicPolicy ()
+{
+	return dynamicpolicy;
+}
+
+// get a policy by name. return the current policy if unknown
+DynamicValueType
+scanDynamicPolicy (const char *policy)
+{
+	for (int ipolicy=eNoDynamicValues; ipolicy<=eDynamicDontRunTarget; ipolicy++)
+		if (strcmp (policy, dynamicpolicynames[ipolicy]) == 0)
+			return (DynamicValueType)ipolicy;
+	return dynamicpolicy;
+}
+
+// get a child with its dynamic type under the current policy
+SBValue
+getDynamicChild (SBValue var, int index)
+{
+	if (dynamicpolicy == eNoDynamicValues)
+		return SBCALL (SBValue_GetChildAtIndex, var.GetChildAtIndex(index));
+	SBValue child = SBCALL (SBValue_GetChildAtIndex, var.GetChildAtIndex(index, dynamicpolicy, true));
+	++dynamicrequests;
+	if (child.IsDynamic())
+		++dynamicvalues;
+	return child;
+}
+
+// make a value prefer its dynamic type under the current policy
+void
+preferDynamic (SBValue var)
+{
+	var.SetPreferDynamicValue (dynamicpolicy);
+}
+
+void
+resetDynamicStats ()
+{
+	dynamicrequests = 0;
+	dynamicvalues = 0;
+}
+
+// {policy="dynamic-dont-run-target",requests="120",dynamic="8"}
+char *
+formatDynamicStats (StringB &statsdescB)
+{
+	statsdescB.catsprintf ("{policy=\"%s\",requests=\"%llu\",dynamic=\"%llu\"}",
+			dynamicpolicynames[dynamicpolicy], dynamicrequests, dynamicvalues);
+	return statsdescB.c_str();
+}
+
+// hash the raw bytes of a value. keep them if they fit a little endian scalar
+// the data of a bitfield is its storage unit, so its value is hashed and no bytes are kept
+unsigned long long
+hashValueData (SBValue value, std::string &bytes, bool bitfield)
+{
+	unsigned long long hash = 14695981039346656037ULL;		// FNV-1a
+	bytes.clear();
+	if (bitfield) {
+		unsigned long long bits = SBCALL (SBValue_GetValueAsUnsigned, value.GetValueAsUnsigned());
+		for (size_t ibyte=0; ibyte<sizeof(bits); ibyte++)
+			hash = (hash ^ ((bits>>(ibyte*8)) & 0xff)) * 1099511628211ULL;
+		return hash;
+	}
+	SBData data = SBCALL (SBValue_GetData, value.GetData());
+	size_t size = data.GetByteSize();
+	bool keep = size<=8 && data.GetByteOrder()==eByteOrderLittle;
+	unsigned char buffer[256];
+	for (size_t offset=0; offset<size; offset+=sizeof(buffer)) {
+		SBError error;
+		size_t read = data.ReadRawData (error, offset, buffer, min(sizeof(buffer),size-offset));
+		if (error.Fail())
+			break;
+		for (size_t ibyte=0; ibyte<read; ibyte++)
+			hash = (hash ^ buffer[ibyte]) * 1099511628211ULL;
+		if (keep)
+			bytes.append ((const char *)buffer, read);
+	}
+	if (bytes.size() != size)								// partly read
+		bytes.clear();
+	return hash;
+}
+
+// start a new stop of the process. called by the listener thread, the variables found at
+// the previous stop are forgotten by the main thread when it looks for variables
+int
+nextStopGeneration ()
+{
+	return ++stopgeneration;
+}
+
+// forget the variables found at a previous stop
+static void
+forgetFoundVariables ()
+{
+	int generation = stopgeneration;
+	if (generation == foundgeneration)
+		return;
+	foundvariables.clear();
+	framevariables.clear();
+	foundgeneration = generation;
+}
+
+int
+getStopGeneration ()
+{
+	return stopgeneration;
+}
+
+// get a variable of a frame by name. args, locals and statics are read once per stop
+static SBValue
+getFrameVariable (SBFrame frame, const char *expression)
+{
+	const bool bArgs = true;
+	const bool bLocals = true;
+	const bool bStatics = true;
+	const bool bInScopeOnly = false;
+	if (!frame.IsValid())
+		return SBValue();
+	forgetFoundVariables ();
+	FRAMEKEY key (frame.GetThread().GetIndexID(), frame.GetFrameID());
+	auto it = framevariables.find (key);
+	if (it == framevariables.end()) {
+		FRAMEVARIABLES &variables = framevariables[key];
+		variables.varslist = SBCALL (SBFrame_GetVariables, frame.GetVariables (bArgs, bLocals, bStatics, bInScopeOnly));
+		for (uint32_t ivar = 0; ivar < variables.varslist.GetSize(); ++ivar) {
+			SBValue var = SBCALL (SBValueList_GetValueAtIndex, variables.varslist.GetValueAtIndex(ivar));
+			const char *varname = SBCALL (SBValue_GetName, var.GetName());
+			if (varname != NULL)
+				variables.indexes.insert (std::make_pair (std::string(varname), (int)ivar));	// first of a name
+		}
+		it = framevariables.find (key);
+	}
+	auto index = it->second.indexes.find (expression);
+	if (index == it->second.indexes.end())
+		return SBValue();
+	return SBCALL (SBValueList_GetValueAtIndex, it->second.varslist.GetValueAtIndex(index->second));
+}
+
 // TODO: implement @ formats for structures like struct S. seems to be a bug in lldb
 bool
 getPseudoArrayVariable (SBFrame frame, const char *expression, SBValue &var)
@@ -68,24 +269,23 @@ getPseudoArrayVariable (SBFrame frame, const char *expression, SBValue &var)
 // - from variable path
 // - from expression evaluation
 bool
-getStandardPathVariable (SBFrame frame, const char *expression, SBValue &var)
+getStandardPathVariable (SBFrame frame, const char *expression, SBValue &var, VariableApproach *approach)
 {
 	logprintf (LOG_TRACE, "getStandardPathVariable (0x%x, %s, 0x%x)\n", &frame, expression, &var);
-	if (true /*!var.IsValid() || var.GetError().Fail()*/) {
-		const bool bArgs = true;
-		const bool bLocals = true;
-		const bool bStatics = true;
-		const bool bInScopeOnly = false;
-		const SBValueList varslist = frame.GetVariables (bArgs, bLocals, bStatics, bInScopeOnly);
-		var = varslist.GetFirstValueByName (expression);
-	}
+	VariableApproach found = VAR_FRAME_VARIABLE;
+	var = getFrameVariable (frame, expression);
 	if (!var.IsValid() || var.GetError().Fail()) {
-		var = frame.GetValueForVariablePath(expression);		// for c[0] or z.a
-		if (!var.IsValid() || var.GetError().Fail())
-			var = frame.EvaluateExpression (expression);
+		found = VAR_VARIABLE_PATH;
+		var = SBCALL (SBFrame_GetValueForVariablePath, frame.GetValueForVariablePath(expression));		// for c[0] or z.a
+		if (!var.IsValid() || var.GetError().Fail()) {
+			found = VAR_EXPRESSION;
+			var = SBCALL_DETAIL (SBFrame_EvaluateExpression, expression, frame.EvaluateExpression (expression));
+		}
 	}
 	if (!var.IsValid() || var.GetError().Fail())
 		return false;
+	if (approach != NULL)
+		*approach = found;
 	var.SetPreferSyntheticValue (true);
 	return true;
 }
@@ -95,53 +295,132 @@ getStandardPathVariable (SBFrame frame, const char *expression, SBValue &var)
 // adjust the name if NULL
 const char *getName ( SBValue &var)
 {
-	const char *varname = var.GetName();
+	const char *varname = SBCALL (SBValue_GetName, var.GetName());
 	if (varname == NULL)
 		varname = "(anonymous)";
 	return varname;
 }
 
 
-// return first or last occurrence of find. If except not null and find first, return NULL
-// if way==1, like strstr, if way=-1, like strrstr
-char *
-strfind (char *string, const char *find, int way, const char *except)
-{
-	size_t stringlen, findlen, exceptlen=0;
-	char *cp;
-	stringlen = strlen(string);
-	findlen = strlen(find);
-	if (except!=NULL)
-		exceptlen = strlen(except);
-	if (findlen > stringlen)
+// index of the children of a type by name: base classes then fields
+// guessed from the type, exact once built from the children of a value
+typedef struct {
+	bool exact;
+	std::map<std::string, int> indexes;
+} CHILDINDEX;
+
+static std::map<std::string, CHILDINDEX> childindexes;		// by canonical type name, kept across stops
+static std::map<std::string, std::set<std::string>> bitfieldmembers;	// by canonical type name
+
+// get the canonical type of a structure, or of the structure pointed to
+// return an invalid type for other types
+static SBType
+getStructType (SBValue &parent)
+{
+	SBType type = SBCALL (SBValue_GetType, parent.GetType());
+	if (type.IsPointerType())
+		type = type.GetPointeeType();
+	else if (type.IsReferenceType())
+		type = type.GetDereferencedType();
+	type = type.GetCanonicalType();
+	if ((type.GetTypeClass() & (eTypeClassStruct|eTypeClassClass|eTypeClassUnion)) == 0)
+		return SBType();
+	return type;
+}
+
+// check if a member of a structure, or of the structure pointed to, is a bitfield
+// members are read once per type. anonymous types are read each time, as their names are shared
+bool
+isBitfieldMember (SBValue parent, const char *membername)
+{
+	if (!parent.IsValid() || membername==NULL)
+		return false;
+	SBType type = getStructType (parent);
+	const char *canonicaltypename = type.IsValid()? type.GetName(): NULL;
+	if (canonicaltypename == NULL)
+		return false;
+	std::set<std::string> anonymousmembers;
+	std::set<std::string> *members = &anonymousmembers;
+	if (strstr (canonicaltypename, "(anonymous") == NULL) {
+		auto it = bitfieldmembers.find (canonicaltypename);
+		if (it != bitfieldmembers.end())
+			return it->second.count (membername) > 0;
+		members = &bitfieldmembers[canonicaltypename];
+	}
+	for (uint32_t ifield = 0; ifield < type.GetNumberOfFields(); ++ifield) {
+		SBTypeMember field = type.GetFieldAtIndex (ifield);
+		if (field.IsBitfield() && field.GetName()!=NULL)
+			members->insert (field.GetName());
+	}
+	return members->count (membername) > 0;
+}
+
+// index the children of a value by name. the first child of a name wins
+static void
+indexChildren (CHILDINDEX &childindex, SBValue &parent, int parentnumchildren)
+{
+	childindex.exact = true;
+	childindex.indexes.clear();
+	for (int ichild = 0; ichild < min(parentnumchildren,limits.children_max); ++ichild) {
+		SBValue child = SBCALL (SBValue_GetChildAtIndex, parent.GetChildAtIndex(ichild));
+		if (child.IsValid())
+			childindex.indexes.insert (std::make_pair (std::string(getName(child)), ichild));
+	}
+}
+
+// get the index of the children of a structure, or of the structure pointed to
+// return NULL for other types and synthetic children, which depend on the value
+static CHILDINDEX *
+getChildIndex (SBValue &parent)
+{
+	if (parent.IsSynthetic())
 		return NULL;
-	for (cp=way>0? string: string+stringlen-findlen; cp>=string && cp<=string+stringlen-findlen; cp+=way) {
-		if (except!=NULL && cp<string+stringlen-exceptlen) {
-			if (strncmp(cp, except, findlen) == 0)
-				return NULL;
-		}
-		if (strncmp(cp, find, findlen) == 0)
-			return cp;
+	SBType type = getStructType (parent);
+	if (!type.IsValid())
+		return NULL;
+	const char *canonicaltypename = type.GetName();
+	if (canonicaltypename == NULL)
+		return NULL;
+	auto it = childindexes.find (canonicaltypename);
+	if (it != childindexes.end())
+		return &it->second;
+	CHILDINDEX &childindex = childindexes[canonicaltypename];
+	childindex.exact = false;
+	int index = 0;
+	for (uint32_t ibase = 0; ibase < type.GetNumberOfDirectBaseClasses(); ++ibase) {
+		const char *basename = type.GetDirectBaseClassAtIndex(ibase).GetType().GetName();
+		childindex.indexes.insert (std::make_pair (std::string(basename!=NULL? basename: "(anonymous)"), index++));
+	}
+	for (uint32_t ifield = 0; ifield < type.GetNumberOfFields(); ++ifield) {
+		const char *fieldname = type.GetFieldAtIndex(ifield).GetName();
+		childindex.indexes.insert (std::make_pair (std::string(fieldname!=NULL? fieldname: "(anonymous)"), index++));
 	}
-	return NULL;
+	return &childindex;
 }
 
-char *
-strup (char *string, int len)
+// get a child by name from the index of its parent type. the index is built again
+// from the children of parent if the type guess was wrong. return false if not found
+static bool
+getIndexedChild (CHILDINDEX &childindex, SBValue &parent, int parentnumchildren, const char *childname, SBValue &child)
 {
-	char *p = string;
-	while (*p) {
-		*p = toupper(*p);
-		p++;
-		if ((len != -1) && ((p - string) >= len))
+	for (int pass = 0; pass < 2; ++pass) {
+		auto it = childindex.indexes.find (childname);
+		if (it != childindex.indexes.end() && it->second < parentnumchildren) {
+			child = SBCALL (SBValue_GetChildAtIndex, parent.GetChildAtIndex(it->second));
+			if (child.IsValid() && strcmp (getName(child), childname) == 0)
+				return true;
+		}
+		if (childindex.exact)
 			break;
+		indexChildren (childindex, parent, parentnumchildren);
 	}
-	return string;
+	child = SBValue();
+	return false;
 }
 
-
 // try go get a variable child from a path by walking its children
 // while there are parts, search children for the remaining
+// children of structures are found by the index of their type, others by scanning
 bool
 getDirectPathVariable (SBFrame frame, const char *expression, SBValue *foundvar, SBValue &parent, int depth)
 {
@@ -187,12 +466,25 @@ getDirectPathVariable (SBFrame frame, const char *expression, SBValue *foundvar,
 	}
 	*/
 	// search children var
-	int parentnumchildren = parent.GetNumChildren();
+	int parentnumchildren = SBCALL (SBValue_GetNumChildren, parent.GetNumChildren());
 	const char *parentname = getName (parent);
 	logprintf (LOG_DEBUG, "getDirectPathVariable: expression part: parentname=%s child-searched=%s, other-children=%s\n",
 			parentname, expression_parts, pchildren==NULL?"":pchildren);
+	CHILDINDEX *childindex = depth>1? getChildIndex (parent): NULL;
+	if (childindex != NULL) {
+		SBValue child;
+		if (!getIndexedChild (*childindex, parent, parentnumchildren, expression_parts, child)
+				|| child.GetError().Fail())
+			return false;
+		child.SetPreferSyntheticValue (true);
+		if (pchildren == NULL) {
+			*foundvar = child;
+			return true;
+		}
+		return getDirectPathVariable (frame, pchildren, foundvar, child, depth-1);
+	}
 	for (int ichild = 0; ichild < min(parentnumchildren,limits.children_max); ++ichild) {
-		SBValue child = parent.GetChildAtIndex(ichild);
+		SBValue child = SBCALL (SBValue_GetChildAtIndex, parent.GetChildAtIndex(ichild));
 		if (child.IsValid() && child.GetError().Success() && depth>1) {
 			child.SetPreferSyntheticValue (true);
 			const char *childname = getName(child);
@@ -246,26 +538,73 @@ castexpression (SBFrame frame, const char *expression, char *newexpression, size
 	return newexpression;
 }
 
+// get a variable with the approach which found it
+static bool
+getApproachVariable (SBFrame frame, const char *expression, VariableApproach approach, SBValue &var)
+{
+	char newexpression[NAME_MAX];
+	switch (approach) {
+	case VAR_PSEUDO_ARRAY:
+		return getPseudoArrayVariable (frame, expression, var);
+	case VAR_EXPRESSION:
+		var = SBCALL_DETAIL (SBFrame_EvaluateExpression, expression, frame.EvaluateExpression (expression));
+		break;
+	case VAR_CAST_EXPRESSION:
+		if (castexpression (frame, expression, newexpression, sizeof(newexpression)) != NULL)
+			getStandardPathVariable (frame, newexpression, var);
+		break;
+	default:
+		var = SBValue();
+	}
+	return var.IsValid() && var.GetError().Success();
+}
+
 // get a variable by trying many approaches
+// the approach which found an expression is remembered until the next stop, with the
+// variable unless it is the result of an evaluation
 SBValue
 getVariable (SBFrame frame, const char *expression, bool tryDirect)
 {
 	logprintf (LOG_TRACE, "getVariable (0x%x, %s)\n", &frame, expression);
+	forgetFoundVariables ();
 	SBValue var;
-	if (strchr(expression,'@') != NULL)
-		getPseudoArrayVariable (frame, expression, var);
-	if ((!var.IsValid() || var.GetError().Fail()) && *expression=='$')
-		var = frame.FindRegister(expression);
+	std::tuple<int, int, std::string> key (frame.GetThread().GetIndexID(), frame.GetFrameID(), expression);
+	auto it = tryDirect? foundvariables.find (key): foundvariables.end();
+	if (it != foundvariables.end()) {
+		logprintf (LOG_DEBUG, "getVariable: expression=%s found at this stop by approach %d\n", expression, it->second.approach);
+		if (it->second.var.IsValid())
+			return it->second.var;
+		if (it->second.approach != VAR_NOT_FOUND)
+			getApproachVariable (frame, expression, it->second.approach, var);
+		if (var.IsValid() && var.GetError().Success())
+			var.SetPreferSyntheticValue (true);
+		return var;
+	}
+	VariableApproach approach = VAR_NOT_FOUND;
+	if (strchr(expression,'@') != NULL && getPseudoArrayVariable (frame, expression, var))
+		approach = VAR_PSEUDO_ARRAY;
+	if ((!var.IsValid() || var.GetError().Fail()) && *expression=='$') {
+		var = SBCALL (SBFrame_FindRegister, frame.FindRegister(expression));
+		approach = VAR_REGISTER;
+	}
 	if ((!var.IsValid() || var.GetError().Fail()) && tryDirect) {
 		SBValue parent;
 		getDirectPathVariable (frame, expression, &var, parent, limits.walk_depth_max);
+		approach = VAR_DIRECT_PATH;
 	}
 	if (!var.IsValid() || var.GetError().Fail())
-		getStandardPathVariable (frame, expression, var);
-	if ((!var.IsValid() || var.GetError().Fail()) && *expression=='&' && *(expression+1)=='(') {
-		char newexpression[NAME_MAX];
-		if (castexpression (frame, expression, newexpression, sizeof(newexpression)) != NULL)
-			getStandardPathVariable (frame, newexpression, var);
+		getStandardPathVariable (frame, expression, var, &approach);
+	if ((!var.IsValid() || var.GetError().Fail()) && *expression=='&' && *(expression+1)=='('
+			&& getApproachVariable (frame, expression, VAR_CAST_EXPRESSION, var))
+		approach = VAR_CAST_EXPRESSION;
+	if (!var.IsValid() || var.GetError().Fail())
+		approach = VAR_NOT_FOUND;
+	if (tryDirect && frame.IsValid()) {
+		FOUNDVARIABLE &found = foundvariables[key];
+		found.approach = approach;
+		if (approach!=VAR_NOT_FOUND && approach!=VAR_PSEUDO_ARRAY
+				&& approach!=VAR_EXPRESSION && approach!=VAR_CAST_EXPRESSION)
+			found.var = var;
 	}
 	logprintf (LOG_DEBUG, "getVariable: expression=%s, name=%s, value=%s, changed=%d\n",
 			expression, getName(var), var.GetValue(), var.GetValueDidChange());
@@ -280,7 +619,7 @@ updateVarState (SBValue var, int depth)
 {
 	logprintf (LOG_TRACE, "updateVarState (0x%x, %d)\n", &var, depth);
 	var.SetPreferSyntheticValue(true);
-	SBType vartype = var.GetType();
+	SBType vartype = SBCALL (SBValue_GetType, var.GetType());
 	logprintf (LOG_DEBUG, "updateVarState: Var=%-5s: children=%-2d, typeclass=%-10s, basictype=%-10s, bytesize=%-2d, Pointee: typeclass=%-10s, basictype=%-10s, bytesize=%-2d\n",
 			getName(var), var.GetNumChildren(), getNameForTypeClass(vartype.GetTypeClass()), getNameForBasicType(vartype.GetBasicType()), vartype.GetByteSize(),
 			getNameForTypeClass(vartype.GetPointeeType().GetTypeClass()), getNameForBasicType(vartype.GetPointeeType().GetBasicType()), vartype.GetPointeeType().GetByteSize());
@@ -290,16 +629,16 @@ updateVarState (SBValue var, int depth)
 	expressionpathdescB.clear();													// temp
 	char *expressionpathdesc = formatExpressionPath (expressionpathdescB, var);		// temp
 	// Force a value to update
-	var.GetValue();									// get value to activate changes
-	int changes = var.GetValueDidChange();
-	const char *summary = var.GetSummary();			// get value to activate changes  ????
-	int varnumchildren = var.GetNumChildren();
+	SBCALL (SBValue_GetValue, var.GetValue());		// get value to activate changes
+	int changes = SBCALL (SBValue_GetValueDidChange, var.GetValueDidChange());
+	const char *summary = SBCALL (SBValue_GetSummary, var.GetSummary());		// get value to activate changes  ????
+	int varnumchildren = SBCALL (SBValue_GetNumChildren, var.GetNumChildren());
 	logprintf (LOG_DEBUG, "updateVarState: name=%s, varexpressionpath=%s, varnumchildren=%d, value=%s, summary=%s, changed=%d\n",
 			getName(var), expressionpathdesc, varnumchildren, var.GetValue(), summary, var.GetValueDidChange());
     // And update its children
 	if (/*!vartype.IsPointerType() && !vartype.IsReferenceType() &&*/ !vartype.IsArrayType()) {
 		for (int ichild = 0; ichild < min(varnumchildren,limits.children_max); ++ichild) {
-			SBValue child = var.GetChildAtIndex(ichild);
+			SBValue child = SBCALL (SBValue_GetChildAtIndex, var.GetChildAtIndex(ichild));
 			if (child.IsValid() && var.GetError().Success() && depth>1) {
 				child.SetPreferSyntheticValue (true);
 				changes += updateVarState (child, depth-1);
@@ -376,34 +715,8 @@ formatExpressionPath (SBValue var)
 char *
 formatExpressionPath (StringB &expressionpathdescB, SBValue var)
 {
-	logprintf (LOG_TRACE, "formatExpressionPath (0x%x, 0x%x)\n", &expressionpathdescB, &var);
-	// child expressions: var2.*b
-	SBStream stream;
-	var.GetExpressionPath (stream, true);
-	expressionpathdescB.append(stream.GetData());
-	const char *varname = var.GetName();
-	if (varname==NULL)
-		expressionpathdescB.append("(anonymous)");
-	logprintf (LOG_DEBUG, "formatExpressionPath: expressionpathdesc=%s\n",
-			varname, expressionpathdescB.c_str());
-	// correct expression
-	char *pstr=expressionpathdescB.c_str(), *pp;
-	int suppress;
-	do {
-		suppress = 0;
-		if ((pp=strstr(pstr,"->[")) != NULL)
-			suppress = 2;
-		else if ((pp=strstr(pstr,".[")) != NULL)
-			suppress = 1;
-		else if ((pp=strstr(pstr,"..")) != NULL)
-			suppress = 1;		// may happen if unions with no name
-		if (suppress > 0)		// remove the offending characters
-			expressionpathdescB.clear(suppress,pp-pstr);		// bytes, start
-	} while (suppress>0);
-	if (expressionpathdescB.size()>0)
-		if (expressionpathdescB.c_str()[expressionpathdescB.size()-1]=='.')
-			expressionpathdescB.c_str()[expressionpathdescB.size()-1] = '\0';		// remove final '.'
-	return expressionpathdescB.c_str();
+	SBValueView varview (var);
+	return formatExpressionPath (expressionpathdescB, varview);
 }
 
 // list children variables
@@ -418,49 +731,8 @@ formatChildrenList (SBValue var, char *expression, int threadindexid, int &varnu
 char *
 formatChildrenList (StringB &childrendescB, SBValue var, char *expression, int threadindexid, int &varnumchildren)
 {
-	logprintf (LOG_TRACE, "formatChildrenList (0x%x, 0x%x, %s, %d, %d)\n", &childrendescB, &var, expression, threadindexid, varnumchildren);
-	var.SetPreferSyntheticValue (true);
-	varnumchildren = var.GetNumChildren();
-	const char *sep="";
-	int ichild;
-	for (ichild=0; ichild<min(varnumchildren,limits.children_max); ichild++) {
-		SBValue child = var.GetChildAtIndex(ichild, eDynamicCanRunTarget, true);
-		if (!child.IsValid())
-			continue;
-		const char *childname = getName(child);				// displayed name
-		if (child.GetError().Fail())
-			logprintf (LOG_DEBUG, "formatChildrenList: error on child %s: %s\n",
-					childname==NULL? "": childname, child.GetError().GetCString());
-		child.SetPreferSyntheticValue (true);
-		int childnumchildren = child.GetNumChildren();
-		SBType childtype = child.GetType();
-		const char *displaytypename = childtype.GetDisplayTypeName();
-		static StringB expressionpathdescB(NAME_MAX);			// real path
-		expressionpathdescB.clear();							// clear previous buffer content
-		if (strcmp(childname,displaytypename)==0)				// if extends class name
-			expressionpathdescB.catsprintf("%s.%s", expression, childname);
-		else {
-			formatExpressionPath (expressionpathdescB, child);
-			
-			if (strcmp((const char *)expression,(const char *)expressionpathdescB.c_str())==0) {
-				SBType vartype = var.GetType();
-				logprintf (LOG_ALL, "formatChildrenList: Var=%-5s: children=%-2d, typeclass=%-10s, basictype=%-10s, bytesize=%-2d, Pointee: typeclass=%-10s, basictype=%-10s, bytesize=%-2d\n",
-						getName(var), var.GetNumChildren(), getNameForTypeClass(vartype.GetTypeClass()), getNameForBasicType(vartype.GetBasicType()), vartype.GetByteSize(),
-						getNameForTypeClass(vartype.GetPointeeType().GetTypeClass()), getNameForBasicType(vartype.GetPointeeType().GetBasicType()), vartype.GetPointeeType().GetByteSize());
-				if (childnumchildren>0)							// breakpoint 1 in largearray.log
-					// special case with casts like StringB or Vector. Add the name to the expression
-					childrendescB.catsprintf (".%s", childname);
-			}
-		}
-		logprintf (LOG_DEBUG, "formatChildrenList (expressionpathdesc=%s, childchildren=%d, childname=%s)\n",
-				expressionpathdescB.c_str(), childnumchildren, childname);
-		// [child={name="var2.*b",exp="*b",numchild="0",type="char",thread-id="1"}]
-		childrendescB.catsprintf ("%schild={name=\"%s\",exp=\"%s\",numchild=\"%d\","
-			"type=\"%s\",thread-id=\"%d\"}",
-			sep, (std::string(expression) + childname).c_str(), childname,childnumchildren,displaytypename,threadindexid);
-		sep = ",";
-	}
-	return childrendescB.c_str();
+	SBValueView varview (var);
+	return formatChildrenList (childrendescB, varview, expression, threadindexid, varnumchildren);
 }
 
 // search changed variables
@@ -469,45 +741,15 @@ formatChangedList (SBValue var, bool &separatorvisible, int depth)
 {
 	static StringB changedescB(BIG_LINE_MAX);
 	changedescB.clear();
+	TraceSpan span ("format", "formatChangedList");
 	return formatChangedList (changedescB, var, separatorvisible, depth);
 }
 
 char *
 formatChangedList (StringB &changedescB, SBValue var, bool &separatorvisible, int depth)
 {
-	logprintf (LOG_TRACE, "formatChangedList (0x%x, 0x%x, %B, %d)\n", &changedescB, &var, separatorvisible, depth);
-	static StringB expressionpathdescB(NAME_MAX);
-	expressionpathdescB.clear();
-	formatExpressionPath (expressionpathdescB, var);
-	if (expressionpathdescB.size()==0)
-		return changedescB.c_str();
-	logprintf (LOG_DEBUG, "formatChangedList: name=%s, expressionpath=%s, value=%s, summary=%s, changed=%d\n",
-			getName(var), expressionpathdescB.c_str(), var.GetValue(), var.GetSummary(), var.GetValueDidChange());
-	var.GetValue();					// required to get value to activate changes
-	var.GetSummary();				// required to get value to activate changes
-	SBType vartype = var.GetType();
-	int varnumchildren = var.GetNumChildren();
-	const char *separator = separatorvisible? ",":"";
-	const char *varinscope = var.IsInScope()? "true": "false";
-	static StringB vardescB(VALUE_MAX);
-	vardescB.clear();								// clear previous buffer content
-	formatValue (vardescB,var, FULL_SUMMARY);		// was NO_SUMMARY
-	changedescB.catsprintf ("%s{name=\"%s\",value=\"%s\",in_scope=\"%s\",type_changed=\"false\",has_more=\"0\"}",
-		separator, expressionpathdescB.c_str(), vardescB.c_str(), varinscope);
-	separatorvisible = true;
-	if (/*varandchildrenchanged>varchanged && */
-			/*!vartype.IsPointerType() && !vartype.IsReferenceType() && */ !vartype.IsArrayType()) {
-		for (int ichild = 0; ichild < min(varnumchildren,limits.children_max); ++ichild) {
-			SBValue child = var.GetChildAtIndex(ichild);
-			if (!child.IsValid() || var.GetError().Fail())
-				continue;
-			child.SetPreferSyntheticValue (true);
-			// Handle composite types (i.e. struct or arrays)
-            if (depth>1)
-            	formatChangedList (changedescB, child, separatorvisible, depth-1);
-		}
-	}
-	return changedescB.c_str();
+	SBValueView varview (var);
+	return formatChangedList (changedescB, varview, separatorvisible, depth);
 }
 
 
@@ -524,30 +766,96 @@ formatVariables (SBValueList varslist)
 char *
 formatVariables (StringB &varsdescB, SBValueList varslist)
 {
-	logprintf (LOG_TRACE, "formatVariables (0x%x, 0x%x)\n", varsdescB.c_str(), &varslist);
+	SBValueListView varslistview (varslist);
+	return formatVariables (varsdescB, varslistview);
+}
+
+char *
+formatVariables (StringB &varsdescB, SBValueList varslist, int printvalues, bool witharguments)
+{
+	SBValueListView varslistview (varslist);
+	return formatVariables (varsdescB, varslistview, printvalues, witharguments);
+}
+
+// format the variables of a frame whose value changed or which came in scope after stop since,
+// then those which went out of scope. scalars are compared by their raw bytes without formatting them
+// locals=[{name="i",value="3"}],out_of_scope=[{name="j"}]
+char *
+formatChangedVariables (StringB &varsdescB, SBFrame frame, SBValueList varslist, int since)
+{
+	logprintf (LOG_TRACE, "formatChangedVariables (0x%x, %d)\n", &frame, since);
+	int generation = getStopGeneration();
+	const char *function = frame.GetFunctionName();
+	std::tuple<int, unsigned long long, std::string> key (frame.GetThread().GetIndexID(), frame.GetCFA(),
+			function!=NULL? function: "");
+	if (framelocals.find (key)==framelocals.end() && framelocals.size()>=FRAMES_MAX) {
+		auto oldest = framelocals.begin();					// forget the least recently listed frame
+		for (auto it = framelocals.begin(); it != framelocals.end(); ++it)
+			if (it->second.listed < oldest->second.listed)
+				oldest = it;
+		framelocals.erase (oldest);
+	}
+	FRAMELOCALS &locals = framelocals[key];
+	locals.listed = generation;
 	varsdescB.clear();
-	const char *separator="";
-	for (size_t i=0; i<varslist.GetSize(); i++) {
-		SBValue var = varslist.GetValueAtIndex(i);
+	varsdescB.append ("locals=[");
+	const char *separator = "";
+	std::map<std::string, int> occurrences;					// of shadowed locals
+	int size = varslist.GetSize();
+	for (int i=0; i<size; i++) {
+		SBValue var = SBCALL (SBValueList_GetValueAtIndex, varslist.GetValueAtIndex(i));
 		var.SetPreferSyntheticValue (true);
-		if (var.IsValid() && var.GetError().Success()) {
-			SBType vartype = var.GetType();
-			logprintf (LOG_DEBUG, "formatVariables: var=%s, type class=%s, basic type=%s \n",
-					getName(var), getNameForTypeClass(vartype.GetTypeClass()), getNameForBasicType(vartype.GetBasicType()));
-			const char *varvalue = var.GetValue();
-			// basic type valid only when type class is Builtin
-			if ((vartype.GetBasicType()!=eBasicTypeInvalid && varvalue!=NULL) || true) {
-			//	updateVarState (var, limits.change_depth_max);
-				static StringB vardescB(BIG_VALUE_MAX);
-				vardescB.clear();								// clear previous buffer content
-				formatValue (vardescB, var, FULL_SUMMARY);
-				varsdescB.catsprintf ("%s{name=\"%s\",value=\"%s\"}",	separator, getName(var), vardescB.c_str());
-				separator=",";
+		if (!var.IsValid() || var.GetError().Fail())
+			continue;
+		SBValueView varview (var);
+		const char *varname = getName (var);
+		std::pair<std::string, int> localkey (varname, occurrences[varname]++);
+		auto it = locals.locals.find (localkey);
+		bool known = it != locals.locals.end();
+		LOCALSNAPSHOT &local = locals.locals[localkey];
+		if (!known) {
+			local.scalar = !(varview.typeflags() & (VIEW_POINTER|VIEW_REFERENCE|VIEW_ARRAY|VIEW_AGGREGATE))
+					&& !var.IsSynthetic();
+			local.hash = 0;
+		}
+		static StringB vardescB(BIG_VALUE_MAX);
+		vardescB.clear();
+		bool changed = !known;								// else compared with its last listing
+		if (local.scalar) {
+			std::string bytes;
+			unsigned long long hash = hashValueData (var, bytes);
+			changed = changed || hash!=local.hash;
+			local.hash = hash;
+		}
+		else {
+			formatValue (vardescB, varview, FULL_SUMMARY);
+			changed = changed || local.value!=vardescB.c_str();
+			local.value = vardescB.c_str();
+		}
+		if (changed)
+			local.changed = generation;
+		local.seen = generation;
+		if (local.changed > since) {
+			if (local.scalar)
+				formatValue (vardescB, varview, FULL_SUMMARY);
+			varsdescB.catsprintf ("%s{name=\"%s\",value=\"%s\"}", separator, varname, vardescB.c_str());
+			separator = ",";
+		}
+	}
+	varsdescB.append ("],out_of_scope=[");
+	separator = "";
+	for (auto it = locals.locals.begin(); it != locals.locals.end(); ) {
+		if (it->second.seen == generation)
+			++it;
+		else {
+			if (it->second.seen >= since) {
+				varsdescB.catsprintf ("%s{name=\"%s\"}", separator, it->first.first.c_str());
+				separator = ",";
 			}
-			else
-				logprintf (LOG_INFO, "formatVariables: var name=%s, invalid\n",	getName(var));
+			it = locals.locals.erase (it);
 		}
 	}
+	varsdescB.append ("]");
 	return varsdescB.c_str();
 }
 
@@ -584,76 +892,8 @@ formatSummary (SBValue var)
 char *
 formatSummary (StringB &summarydescB, SBValue var)
 {
-	logprintf (LOG_TRACE, "formatSummary (0x%x, 0x%x)\n", &summarydescB, &var);
-	//	value = "HFG\123klj\b"
-	//	value={2,5,7,0 <repeat 5 times>, 7}
-	//	value = {{a=1,b=0x33},...{a=1,b=2}}
-	const char *varsummary = var.GetSummary();
-	SBType vartype = var.GetType();
-	logprintf (LOG_DEBUG, "formatSummary: Var=%-5s: children=%-2d, typeclass=%-10s, basictype=%-10s, bytesize=%-2d, Pointee: typeclass=%-10s, basictype=%-10s, bytesize=%-2d\n",
-				getName(var), var.GetNumChildren(), getNameForTypeClass(vartype.GetTypeClass()), getNameForBasicType(vartype.GetBasicType()), vartype.GetByteSize(),
-				getNameForTypeClass(vartype.GetPointeeType().GetTypeClass()), getNameForBasicType(vartype.GetPointeeType().GetBasicType()), vartype.GetPointeeType().GetByteSize());
-	if (varsummary && *varsummary == '"') {				// string
-		// copy varsummary in summarydescB.exclude heading & trainling apostrophe. escape inner apostrophes if required
-		for (const char *ps=varsummary+1; *ps&&*(ps+1); ps++) {
-			if (*ps=='"' && *(ps-1)!='\\')
-				summarydescB.append ('\\');
-			summarydescB.append (*ps);
-		}
-		return summarydescB.c_str();
-	}
-	TypeClass vartypeclass = vartype.GetTypeClass();
-	SBType pointeetype = vartype.GetPointeeType();
-	int numchildren = var.GetNumChildren();
-#if 0
-	int datasize=0;
-	if (vartype.IsArrayType())
-		datasize = var.GetByteSize();
-	else if (vartype.IsReferenceType())
-		datasize = pointeetype.GetByteSize();
-	else if (vartype.IsPointerType())
-		datasize = pointeetype.GetByteSize();
-#endif
-	
-	if (vartypeclass==eTypeClassClass || vartypeclass==eTypeClassStruct || vartypeclass==eTypeClassUnion || vartype.IsArrayType()) {
-		const char *separator="";
-		static StringB vardescB(VALUE_MAX);
-		if (varsummary && *varsummary) {
-			summarydescB.append(varsummary);
-			summarydescB.append(" ");
-		}
-		summarydescB.append("{");
-		for (int ichild=0; ichild<min(numchildren,limits.children_max); ichild++) {
-			SBValue child = var.GetChildAtIndex(ichild);
-			if (!child.IsValid() || var.GetError().Fail())
-				continue;
-			child.SetPreferSyntheticValue (true);
-			const char *childvalue = child.GetValue();
-			vardescB.clear();						// clear previous buffer content
-			if (childvalue != NULL)
-				if (vartype.IsArrayType())
-					vardescB.catsprintf ("%s%s", separator, childvalue);
-				else
-					vardescB.catsprintf ("%s%s=%s", separator, getName(child), childvalue);
-			else {
-				SBType childtype = var.GetType();
-				lldb::addr_t childaddr;
-				if (childtype.IsPointerType() || childtype.IsReferenceType())
-					childaddr = var.GetValueAsUnsigned();
-				else
-					childaddr = var.GetLoadAddress();
-				if (vartype.IsArrayType())
-					vardescB.catsprintf ("%s%p", separator, childaddr);
-				else
-					vardescB.catsprintf ("%s%s=%p", separator, getName(child), childaddr);
-			}
-			summarydescB.append(vardescB.c_str());
-			separator = ",";
-		}
-		summarydescB.append("}");
-		return summarydescB.c_str();
-	}
-	return NULL;
+	SBValueView varview (var);
+	return formatSummary (summarydescB, varview);
 }
 
 // format a variable description into a GDB string
@@ -748,44 +988,6 @@ formatStruct (StringB &s, SBValue var)
 char *
 formatValue (StringB &vardescB, SBValue var, VariableDetails details)
 {
-	logprintf (LOG_TRACE, "formatValue (0x%x, 0x%x, %x)\n", &vardescB, &var, details);
-	//	value = "HFG\123klj\b"
-	//	value={2,5,7,0 <repeat 5 times>, 7}
-	//	value = {{a=1,b=0x33},...{a=1,b=2}}
-	vardescB.clear();
-	if (var.GetError().Fail())		// invalid value. show nothing
-		return vardescB.c_str();
-	SBType vartype = var.GetType();
-	logprintf (LOG_DEBUG, "formatValue: Var=%-5s: children=%-2d, typeclass=%-10s, basictype=%-10s, bytesize=%-2d, Pointee: typeclass=%-10s, basictype=%-10s, bytesize=%-2d\n",
-		getName(var), var.GetNumChildren(), getNameForTypeClass(vartype.GetTypeClass()), getNameForBasicType(vartype.GetBasicType()), vartype.GetByteSize(),
-		getNameForTypeClass(vartype.GetPointeeType().GetTypeClass()), getNameForBasicType(vartype.GetPointeeType().GetBasicType()), vartype.GetPointeeType().GetByteSize());
-	const char *varname = getName(var);
-	static StringB summarydescB(BIG_LINE_MAX);
-	summarydescB.clear();								// clear previous buffer content
-	formatSummary (summarydescB, var);
-	const char *varvalue = var.GetValue();
-	lldb::addr_t varaddr;
-	if (vartype.IsPointerType() || vartype.IsReferenceType())
-		varaddr = var.GetValueAsUnsigned();
-	else
-		varaddr = var.GetLoadAddress();
-	logprintf (LOG_DEBUG, "formatValue: var=%p, name=%s, summary=%s, value=%s, address=%p\n",
-			&var, varname, summarydescB.c_str(), varvalue, varaddr);
-
-	if (varvalue != NULL) {			// basic types and arrays
-		if (vartype.IsPointerType() || vartype.IsReferenceType() || vartype.IsArrayType()) {
-			if (summarydescB.size()>0 && details==FULL_SUMMARY)
-				vardescB.catsprintf ("%s \\\"%s\\\"", varvalue, summarydescB.c_str());
-			else
-				vardescB.catsprintf ("%s", varvalue);
-		}
-		else		// basic type
-			vardescB.append(varvalue);
-	}
-	// classes and structures
-	else if (summarydescB.size()>0 && details==FULL_SUMMARY)
-		vardescB.catsprintf ("%p \\\"%s\\\"", varaddr, summarydescB.c_str());
-	else
-		vardescB.catsprintf ("%p", varaddr);
-	return vardescB.c_str();
+	SBValueView varview (var);
+	return formatValue (vardescB, varview, details);
 }
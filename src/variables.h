@@ -5,28 +5,41 @@
 #include <lldb/API/LLDB.h>
 using namespace lldb;
 
-typedef enum
-{
-	NO_SUMMARY		= 0x1,
-	FULL_SUMMARY	= 0x2,
-} VariableDetails;
-
-
-#define CHANGE_DEPTH_MAX    3		// maximum depth to check variables changed
-#define WALK_DEPTH_MAX      9		// maximum depth to walk variables when searching expressions
-#define ARRAY_MAX         200		// maximum number of children to display. must be a multiple of 8
-#define CHILDREN_MAX      150		// limit of children to examine when walking in them
+#include <string>
+#include "format.h"
 
 
 #define min(a,b) ((a) < (b) ? (a) : (b))
 
+// approach which found a variable
+typedef enum
+{
+	VAR_NOT_FOUND = 0,
+	VAR_PSEUDO_ARRAY,
+	VAR_REGISTER,
+	VAR_DIRECT_PATH,
+	VAR_FRAME_VARIABLE,
+	VAR_VARIABLE_PATH,
+	VAR_EXPRESSION,
+	VAR_CAST_EXPRESSION
+} VariableApproach;
+
+void  setDynamicPolicy (DynamicValueType policy);
+DynamicValueType getDynamicPolicy ();
+DynamicValueType scanDynamicPolicy (const char *policy);
+SBValue getDynamicChild (SBValue var, int index);
+void  preferDynamic (SBValue var);
+void  resetDynamicStats ();
+char *formatDynamicStats (StringB &statsdescB);
+unsigned long long hashValueData (SBValue value, std::string &bytes, bool bitfield=false);
+bool  isBitfieldMember (SBValue parent, const char *membername);
+int   nextStopGeneration ();
+int   getStopGeneration ();
 bool  getPseudoArrayVariable (SBFrame frame, const char *expression, SBValue &var);
-bool  getStandardPathVariable (SBFrame frame, const char *expression, SBValue &var);
+bool  getStandardPathVariable (SBFrame frame, const char *expression, SBValue &var, VariableApproach *approach=NULL);
 const char *getName ( SBValue &var);
-char *strfind (char *string, const char *find, int way=1, const char *except=NULL);
 bool  getDirectPathVariable (SBFrame frame, const char *expression, SBValue *foundvar, SBValue &parent, int depth);
 char *castexpression (SBFrame frame, const char *expression, char *newexpression, size_t expressionsize);
-char *strup (char *string, int len);
 
 SBValue getVariable (SBFrame frame, const char *expression, bool tryDirect=true);
 int     updateVarState (SBValue var, int depth);
@@ -37,6 +50,8 @@ char * formatExpressionPath (StringB &expressionpathdescB, SBValue var);
 char * formatChildrenList (StringB &childrendescB, SBValue var, char *expression, int threadindexid, int &varnumchildren);
 char * formatChangedList (StringB &changedescB, SBValue var, bool &separatorvisible, int depth);
 char * formatVariables (StringB &varsdescB, SBValueList varslist);
+char * formatVariables (StringB &varsdescB, SBValueList varslist, int printvalues, bool witharguments);
+char * formatChangedVariables (StringB &varsdescB, SBFrame frame, SBValueList varslist, int since);
 char * formatSummary (StringB &summarydescB, SBValue var);
 char * formatValue (StringB &varsdescB, SBValue var, VariableDetails details);
 char * formatDesc (StringB &vardescB, SBValue var);
@@ -0,0 +1,660 @@
+
+#include <algorithm>
+
+#include "lldbmi2.h"
+#include "log.h"
+#include "sbstats.h"
+#include "sbviews.h"
+#include "variables.h"
+#include "varobjs.h"
+
+extern LIMITS limits;
+
+// LLDB formats of the varobj formats, by ValueFormat
+const Format formatcodes[] = { eFormatDefault, eFormatBinary, eFormatOctal, eFormatDecimal, eFormatHex };
+
+
+VarobjTable::VarobjTable () {
+	nextid = 1;
+	nextorder = 1;
+	live = 0;
+	evictions = 0;
+	framesgeneration = 0;
+	listedgeneration = 0;
+}
+
+VarobjTable::~VarobjTable () {
+	clear ();
+}
+
+// create a root varobj named name, or varN if name is NULL. return NULL if name exists
+// a floating root is evaluated again in the selected frame at each stop. a root on a local
+// or an argument of frame, or on a path through one, is bound to frame. globals, registers
+// and results of expressions are not
+VAROBJ *
+VarobjTable::create (const char *name, const char *expression, SBValue value, SBFrame frame, bool floating)
+{
+	logprintf (LOG_TRACE, "VarobjTable::create (%s, %s, %B)\n", name, expression, floating);
+	std::string varname = name!=NULL? name: "var" + std::to_string (nextid++);
+	if (varobjs.find (varname) != varobjs.end())
+		return NULL;
+	VAROBJ *varobj = insert (varname, expression, value, NULL, -1);
+	varobj->threadindexid = frame.GetThread().GetIndexID();
+	varobj->frameid = frame.GetFrameID();
+	varobj->floating = floating;
+	varobj->generation = getStopGeneration();
+	ValueType valuetype = value.GetValueType();				// children have the type of their root
+	if (!floating && (valuetype==eValueTypeVariableLocal || valuetype==eValueTypeVariableArgument)) {
+		const char *function = frame.GetFunctionName();
+		varobj->cfa = frame.GetCFA();
+		varobj->function = function!=NULL? function: "";
+	}
+	return varobj;
+}
+
+// get the child at index of a varobj, registered as a lazy handle if not yet in the table
+// the name, type and number of children are read again at each stop as the program may
+// have changed them, and kept for the next listings of this stop. return NULL if no child at index
+VAROBJ *
+VarobjTable::child (VAROBJ *parent, int index)
+{
+	droplisted ();
+	auto it = parent->children.find (index);
+	if (it != parent->children.end() && it->second->listed==getStopGeneration()) {
+		touch (it->second);
+		return it->second;
+	}
+	SBValue value = getDynamicChild (parent->value, index);
+	if (!value.IsValid())
+		return NULL;
+	return addchild (parent, index, value, true);
+}
+
+// fetch the value of a lazy child, kept from its listing at this stop or from its parent
+void
+VarobjTable::materialize (VAROBJ *varobj)
+{
+	if (!varobj->lazy)
+		return;
+	logprintf (LOG_TRACE, "VarobjTable::materialize (%s)\n", varobj->name.c_str());
+	droplisted ();
+	VAROBJ *parent = varobj->parent;
+	materialize (parent);
+	SBValue value = varobj->listedvalue;
+	if (varobj->listed!=getStopGeneration() || !value.IsValid()) {
+		value = getDynamicChild (parent->value, varobj->index);
+		const char *childname = SBCALL (SBValue_GetName, value.GetName());
+		if (childname==NULL || varobj->expression!=childname)		// children moved since the listing
+			value = SBValue();
+	}
+	varobj->listedvalue = SBValue();
+	listedchildren.erase (varobj);
+	varobj->lazy = false;
+	setvalue (varobj, value);
+	if (value.IsValid())
+		++live;
+	snapshot (varobj);
+}
+
+// register a child of a varobj as parent.child, lazy or with its value
+// return the existing varobj if registered
+VAROBJ *
+VarobjTable::addchild (VAROBJ *parent, int index, SBValue child, bool lazy)
+{
+	const char *childname = SBCALL (SBValue_GetName, child.GetName());
+	if (childname == NULL)
+		childname = "";
+	std::string name = parent->name + "." + childname;
+	VAROBJ *varobj;
+	auto it = varobjs.find (name);
+	if (it == varobjs.end())
+		varobj = insert (name, childname, lazy? SBValue(): child, parent, index);
+	else {
+		varobj = it->second;
+		if (!lazy) {
+			if (!varobj->value.IsValid() && child.IsValid())
+				++live;
+			setvalue (varobj, child);
+			if (varobj->lazy)
+				snapshot (varobj);
+		}
+		touch (varobj);
+	}
+	varobj->lazy = lazy && !varobj->value.IsValid();
+	varobj->listedvalue = varobj->lazy? child: SBValue();
+	if (varobj->lazy)
+		listedchildren.insert (varobj);
+	else
+		listedchildren.erase (varobj);
+	varobj->listed = getStopGeneration();
+	const char *childtype = SBCALL (SBValue_GetType, child.GetType()).GetDisplayTypeName();
+	varobj->type = childtype!=NULL? childtype: "";
+	varobj->numchildren = SBCALL (SBValue_GetNumChildren, child.GetNumChildren());
+	return varobj;
+}
+
+// get a varobj by name. evaluate again an evicted root and register again evicted children
+// from their nearest ancestor. return NULL if unknown
+// a bound root is evaluated in its frame, and stays without value if its frame is gone
+// other roots are evaluated in frame
+VAROBJ *
+VarobjTable::find (const char *name, SBFrame frame)
+{
+	logprintf (LOG_TRACE, "VarobjTable::find (%s)\n", name);
+	droplisted ();
+	auto it = varobjs.find (name);
+	if (it == varobjs.end())
+		return resolve (name, frame);
+	VAROBJ *varobj = it->second;
+	rebind (varobj, frame);
+	if (!varobj->value.IsValid() && varobj->parent==NULL) {
+		SBFrame rootframe = frame;
+		if (varobj->cfa != LLDB_INVALID_ADDRESS)
+			rootframe = boundframe (varobj, frame.GetThread().GetProcess());
+		if (rootframe.IsValid())
+			setvalue (varobj, getVariable (rootframe, varobj->expression.c_str()));
+		if (varobj->value.IsValid())
+			++live;
+	}
+	materialize (varobj);
+	touch (varobj);
+	if (live > limits.varobjs_max)
+		evict ();
+	return varobj;
+}
+
+// delete a varobj and its children, or only its children. return the number of deleted varobjs
+// or -1 if unknown
+int
+VarobjTable::remove (const char *name, bool childrenonly)
+{
+	logprintf (LOG_TRACE, "VarobjTable::remove (%s, %B)\n", name, childrenonly);
+	auto it = varobjs.find (name);
+	if (it == varobjs.end())
+		return -1;
+	VAROBJ *varobj = it->second;
+	if (!childrenonly)
+		return erase (varobj);
+	int deleted = 0;
+	std::map<int, VAROBJ *> children = varobj->children;
+	for (auto &entry : children)
+		deleted += erase (entry.second);
+	return deleted;
+}
+
+// freeze or unfreeze a varobj. return false if unknown
+bool
+VarobjTable::setfrozen (const char *name, bool frozen)
+{
+	logprintf (LOG_TRACE, "VarobjTable::setfrozen (%s, %B)\n", name, frozen);
+	auto it = varobjs.find (name);
+	if (it == varobjs.end())
+		return false;
+	it->second->frozen = frozen;
+	return true;
+}
+
+// update only the children from to to-1 of a varobj, or all if from or to is negative
+// return false if unknown
+bool
+VarobjTable::setupdaterange (const char *name, int from, int to)
+{
+	logprintf (LOG_TRACE, "VarobjTable::setupdaterange (%s, %d, %d)\n", name, from, to);
+	auto it = varobjs.find (name);
+	if (it == varobjs.end())
+		return false;
+	it->second->updatefrom = from;
+	it->second->updateto = to;
+	return true;
+}
+
+// change the format of a varobj and format its value. scalars are formatted from
+// their bytes read at this stop, without reading the program again
+// return NULL if the value is unknown
+char *
+VarobjTable::setformat (StringB &vardescB, VAROBJ *varobj, ValueFormat format)
+{
+	logprintf (LOG_TRACE, "VarobjTable::setformat (%s, %d)\n", varobj->name.c_str(), format);
+	varobj->format = format;
+	if (!varobj->value.IsValid())
+		return NULL;
+	varobj->value.SetFormat (formatcodes[format]);
+	VARSNAPSHOT &snapshot = varobj->snapshot;
+	bool current = snapshot.inscope && snapshot.generation==getStopGeneration();
+	if (current && format==FORMAT_NATURAL && !snapshot.natural.empty())
+		vardescB.append (snapshot.natural.c_str());
+	else if (!current || formatRawValue (vardescB, (const unsigned char *)snapshot.bytes.data(),
+				(int)snapshot.bytes.size(), format) == NULL) {
+		SBValueView var (varobj->value);
+		formatValue (vardescB, var, FULL_SUMMARY);
+	}
+	snapshot.value = vardescB.c_str();					// not a change at the next update
+	if (format == FORMAT_NATURAL)
+		snapshot.natural = snapshot.value;
+	return vardescB.c_str();
+}
+
+// delete all varobjs
+void
+VarobjTable::clear ()
+{
+	for (auto &entry : varobjs)
+		delete entry.second;
+	varobjs.clear();
+	lru.clear();
+	listedchildren.clear();
+	evictedindexes.clear();
+	live = 0;
+}
+
+// report the changes of a varobj and of its children since the previous update
+// frozen children and children out of the update range are skipped
+// printvalues: 0 no values, 1 all values, 2 values of simple types
+// 41^done,changelist=[{name="var3",value="44",in_scope="true",type_changed="false",has_more="0"}]
+char *
+VarobjTable::update (StringB &changedescB, VAROBJ *varobj, int printvalues, bool &separatorvisible, SNAPSHOTCACHE *cache)
+{
+	logprintf (LOG_TRACE, "VarobjTable::update (%s, %d)\n", varobj->name.c_str(), printvalues);
+	if (varobj->lazy)										// value never used by the IDE
+		return changedescB.c_str();
+	VARSNAPSHOT previous = varobj->snapshot;
+	if (framealive (varobj))
+		snapshot (varobj, cache);
+	else
+		varobj->snapshot.inscope = false;						// without reading the value
+	const VARSNAPSHOT &current = varobj->snapshot;
+	const char *separator = separatorvisible? ",": "";
+	if (!current.inscope) {									// children are out of scope too
+		if (previous.inscope) {
+			changedescB.catsprintf ("%s{name=\"%s\",in_scope=\"false\",type_changed=\"false\",has_more=\"0\"}",
+				separator, varobj->name.c_str());
+			separatorvisible = true;
+		}
+		return changedescB.c_str();
+	}
+	bool withvalue = printvalues==1 || (printvalues==2 && current.simple);
+	if (current.type != previous.type && previous.inscope) {	// children of the previous type are gone
+		std::map<int, VAROBJ *> children = varobj->children;
+		for (auto &entry : children)
+			erase (entry.second);
+		int numchildren = SBCALL (SBValue_GetNumChildren, varobj->value.GetNumChildren());
+		changedescB.catsprintf ("%s{name=\"%s\"", separator, varobj->name.c_str());
+		if (withvalue)
+			changedescB.catsprintf (",value=\"%s\"", current.value.c_str());
+		changedescB.catsprintf (",in_scope=\"true\",type_changed=\"true\",new_type=\"%s\",new_num_children=\"%d\",has_more=\"0\"}",
+			current.type.c_str(), numchildren);
+		separatorvisible = true;
+		return changedescB.c_str();
+	}
+	if (!previous.inscope || current.hash!=previous.hash || current.value!=previous.value) {
+		changedescB.catsprintf ("%s{name=\"%s\"", separator, varobj->name.c_str());
+		if (withvalue)
+			changedescB.catsprintf (",value=\"%s\"", current.value.c_str());
+		changedescB.append (",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"}");
+		separatorvisible = true;
+	}
+	std::vector<VAROBJ *> children;
+	auto first = varobj->children.begin(), last = varobj->children.end();
+	if (varobj->updatefrom>=0 && varobj->updateto>=0) {		// only the window
+		first = varobj->children.lower_bound (varobj->updatefrom);
+		last = varobj->children.lower_bound (std::max(varobj->updatefrom,varobj->updateto));
+	}
+	for (auto it = first; it != last; ++it)
+		if (!it->second->frozen)
+			children.push_back (it->second);
+	for (size_t ichild=0; ichild<children.size(); ichild++)
+		update (changedescB, children[ichild], printvalues, separatorvisible, cache);
+	return changedescB.c_str();
+}
+
+// report the changes of all varobjs in one pass, frame after frame
+// varobjs on the same object share one snapshot. frozen varobjs are skipped
+// floating varobjs are evaluated in frame
+char *
+VarobjTable::updateall (StringB &changedescB, SBFrame frame, int printvalues)
+{
+	logprintf (LOG_TRACE, "VarobjTable::updateall (%d)\n", printvalues);
+	droplisted ();
+	std::vector<VAROBJ *> roots;
+	for (auto &entry : varobjs)
+		if (entry.second->parent==NULL && !entry.second->frozen) {
+			rebind (entry.second, frame);
+			framealive (entry.second);						// where the frame is now
+			roots.push_back (entry.second);
+		}
+	std::sort (roots.begin(), roots.end(), [](const VAROBJ *a, const VAROBJ *b) {
+		if (a->threadindexid != b->threadindexid)
+			return a->threadindexid < b->threadindexid;
+		if (a->frameid != b->frameid)
+			return a->frameid < b->frameid;
+		return a->id < b->id;
+	});
+	SNAPSHOTCACHE cache;
+	bool separatorvisible = false;
+	for (size_t iroot=0; iroot<roots.size(); iroot++)
+		update (changedescB, roots[iroot], printvalues, separatorvisible, &cache);
+	return changedescB.c_str();
+}
+
+int
+VarobjTable::size ()
+{
+	return (int)varobjs.size();
+}
+
+int
+VarobjTable::livesize ()
+{
+	return live;
+}
+
+int
+VarobjTable::evicted ()
+{
+	return evictions;
+}
+
+VAROBJ *
+VarobjTable::insert (const std::string &name, const char *expression, SBValue value, VAROBJ *parent, int index)
+{
+	VAROBJ *varobj = new VAROBJ;
+	varobj->id = nextorder++;
+	varobj->name = name;
+	varobj->expression = expression;
+	varobj->value = value;
+	varobj->parent = parent;
+	varobj->index = index;
+	varobj->lazy = false;
+	varobj->listed = 0;
+	varobj->numchildren = 0;
+	varobj->frozen = false;
+	varobj->updatefrom = -1;
+	varobj->updateto = -1;
+	varobj->format = FORMAT_NATURAL;
+	varobj->floating = false;
+	varobj->cfa = LLDB_INVALID_ADDRESS;
+	varobj->generation = 0;
+	varobj->threadindexid = parent!=NULL? parent->threadindexid: 0;
+	varobj->frameid = parent!=NULL? parent->frameid: 0;
+	varobj->refcount = 1;
+	if (parent != NULL) {
+		parent->children[index] = varobj;
+		++parent->refcount;
+	}
+	lru.push_front (varobj);
+	varobj->lru = lru.begin();
+	varobjs[name] = varobj;
+	evictedindexes.erase (name);
+	if (value.IsValid())
+		++live;
+	snapshot (varobj);
+	if (live > limits.varobjs_max)
+		evict ();
+	return varobj;
+}
+
+// register again a child removed from the table, from its nearest registered ancestor
+VAROBJ *
+VarobjTable::resolve (const std::string &name, SBFrame frame)
+{
+	size_t separator = name.rfind ('.');
+	while (separator != std::string::npos && varobjs.find (name.substr (0,separator)) == varobjs.end())
+		separator = separator>0? name.rfind ('.', separator-1): std::string::npos;
+	if (separator == std::string::npos)
+		return NULL;
+	VAROBJ *varobj = find (name.substr(0,separator).c_str(), frame);
+	while (varobj!=NULL && separator!=std::string::npos) {
+		size_t next = name.find ('.', separator+1);
+		std::string childname = name.substr (separator+1, next==std::string::npos? next: next-separator-1);
+		varobj = resolvechild (varobj, name.substr (0, next), childname);
+		separator = next;
+	}
+	return varobj;
+}
+
+// register again the child childname of varobj, named name. it is looked for at its index
+// when evicted, at N for [N], then among the first children_max children
+VAROBJ *
+VarobjTable::resolvechild (VAROBJ *varobj, const std::string &name, const std::string &childname)
+{
+	SBValue value = varobj->value;
+	if (!value.IsValid())
+		return NULL;
+	std::vector<int> guesses;
+	auto evicted = evictedindexes.find (name);
+	if (evicted != evictedindexes.end())
+		guesses.push_back (evicted->second);
+	int arrayindex;
+	char end;
+	if (sscanf (childname.c_str(), "[%d%c", &arrayindex, &end)==2 && end==']')
+		guesses.push_back (arrayindex);
+	int numchildren = SBCALL (SBValue_GetNumChildren, value.GetNumChildren());
+	for (size_t iguess=0; iguess<guesses.size(); iguess++) {
+		if (guesses[iguess]<0 || guesses[iguess]>=numchildren)
+			continue;
+		SBValue childvalue = getDynamicChild (value, guesses[iguess]);
+		const char *childvaluename = SBCALL (SBValue_GetName, childvalue.GetName());
+		if (childvaluename!=NULL && childname==childvaluename)
+			return addchild (varobj, guesses[iguess], childvalue, false);
+	}
+	for (int ichild=0; ichild<min(numchildren,limits.children_max); ichild++) {
+		SBValue childvalue = getDynamicChild (value, ichild);
+		const char *childvaluename = SBCALL (SBValue_GetName, childvalue.GetName());
+		if (childvaluename!=NULL && childname==childvaluename)
+			return addchild (varobj, ichild, childvalue, false);
+	}
+	return NULL;
+}
+
+// keep the state of a varobj to detect its changes at the next update
+void
+VarobjTable::snapshot (VAROBJ *varobj, SNAPSHOTCACHE *cache)
+{
+	VARSNAPSHOT &snapshot = varobj->snapshot;
+	snapshot.inscope = varobj->value.IsValid() && SBCALL (SBValue_IsInScope, varobj->value.IsInScope());
+	if (!snapshot.inscope)
+		return;
+	SBValueView var (varobj->value);
+	const char *vartype = var.displaytypename();
+	snapshot.type = vartype!=NULL? vartype: "";
+	snapshot.generation = getStopGeneration();
+	// bitfields in one storage unit have the same address and type, so they are not shared
+	bool bitfield = varobj->parent!=NULL && isBitfieldMember (varobj->parent->value, varobj->expression.c_str());
+	std::pair<unsigned long long, std::string> object (LLDB_INVALID_ADDRESS, snapshot.type);
+	if (cache!=NULL && varobj->format==FORMAT_NATURAL && !bitfield) {	// shared in natural format only
+		object.first = var.loadaddress();
+		auto it = cache->find (object);
+		if (it != cache->end()) {						// object yet read
+			snapshot = it->second;
+			return;
+		}
+	}
+	static StringB vardescB(VALUE_MAX);
+	vardescB.clear();
+	formatValue (vardescB, var, FULL_SUMMARY);
+	snapshot.value = vardescB.c_str();
+	snapshot.simple = !(var.typeflags() & (VIEW_AGGREGATE|VIEW_ARRAY));
+	snapshot.hash = 0;
+	snapshot.bytes.clear();
+	if (snapshot.simple)											// aggregates change by their children
+		snapshot.hash = hashValueData (varobj->value, snapshot.bytes, bitfield);
+	snapshot.natural = varobj->format==FORMAT_NATURAL? snapshot.value: "";
+	if (cache!=NULL && object.first!=LLDB_INVALID_ADDRESS)
+		(*cache)[object] = snapshot;
+}
+
+// check if the frame of a bound root is still in its thread. frames are found by cfa and
+// function, from the top of the stack down to the frame. checked once per stop and frame
+bool
+VarobjTable::framealive (VAROBJ *varobj)
+{
+	if (varobj->parent!=NULL || varobj->cfa==LLDB_INVALID_ADDRESS || !varobj->value.IsValid())
+		return true;
+	if (framesgeneration != getStopGeneration()) {
+		frames.clear();
+		framesgeneration = getStopGeneration();
+	}
+	std::pair<int, unsigned long long> key (varobj->threadindexid, varobj->cfa);
+	auto it = frames.find (key);
+	if (it != frames.end())
+		return it->second;
+	bool alive = boundframe (varobj, varobj->value.GetProcess()).IsValid();
+	logprintf (LOG_DEBUG, "VarobjTable::framealive: %s %s\n", varobj->name.c_str(), alive? "alive": "gone");
+	frames[key] = alive;
+	return alive;
+}
+
+// find the frame of a bound root in its thread, by cfa and function from the top of the stack
+// return an invalid frame if gone
+SBFrame
+VarobjTable::boundframe (VAROBJ *varobj, SBProcess process)
+{
+	SBThread thread = process.GetThreadByIndexID (varobj->threadindexid);
+	for (uint32_t iframe=0; thread.IsValid(); iframe++) {
+		SBFrame frame = SBCALL (SBThread_GetFrameAtIndex, thread.GetFrameAtIndex(iframe));
+		if (!frame.IsValid() || frame.GetCFA() > varobj->cfa)		// callers are above
+			break;
+		const char *function = frame.GetFunctionName();
+		if (frame.GetCFA()==varobj->cfa && varobj->function==(function!=NULL? function: "")) {
+			varobj->frameid = frame.GetFrameID();
+			return frame;
+		}
+	}
+	return SBFrame();
+}
+
+// evaluate a floating root in frame once per stop, with the variables found at this stop
+// its children are fetched again from the new value
+void
+VarobjTable::rebind (VAROBJ *varobj, SBFrame frame)
+{
+	if (!varobj->floating || varobj->generation==getStopGeneration() || !frame.IsValid())
+		return;
+	logprintf (LOG_TRACE, "VarobjTable::rebind (%s)\n", varobj->name.c_str());
+	varobj->generation = getStopGeneration();
+	varobj->threadindexid = frame.GetThread().GetIndexID();
+	varobj->frameid = frame.GetFrameID();
+	release (varobj);
+	setvalue (varobj, getVariable (frame, varobj->expression.c_str()));
+	if (varobj->value.IsValid()) {
+		preferDynamic (varobj->value);
+		++live;
+	}
+	refetch (varobj);
+}
+
+// fetch again the values of the children of a varobj which were used. lazy ones stay lazy
+void
+VarobjTable::refetch (VAROBJ *varobj)
+{
+	for (auto &entry : varobj->children) {
+		VAROBJ *child = entry.second;
+		if (child->lazy)
+			continue;
+		release (child);
+		if (varobj->value.IsValid()) {
+			SBValue value = getDynamicChild (varobj->value, child->index);
+			const char *childname = SBCALL (SBValue_GetName, value.GetName());
+			if (childname!=NULL && child->expression==childname) {
+				setvalue (child, value);
+				++live;
+			}
+		}
+		refetch (child);
+	}
+}
+
+// forget the values of the lazy children listed at a previous stop
+// they are fetched again from their parent when used
+void
+VarobjTable::droplisted ()
+{
+	if (listedgeneration == getStopGeneration())
+		return;
+	for (VAROBJ *varobj : listedchildren)
+		varobj->listedvalue = SBValue();
+	listedchildren.clear();
+	listedgeneration = getStopGeneration();
+}
+
+// give a new value to a varobj, in the format of the varobj
+void
+VarobjTable::setvalue (VAROBJ *varobj, SBValue value)
+{
+	varobj->value = value;
+	if (value.IsValid() && varobj->format!=FORMAT_NATURAL)
+		varobj->value.SetFormat (formatcodes[varobj->format]);
+}
+
+// mark as most recently used
+void
+VarobjTable::touch (VAROBJ *varobj)
+{
+	lru.splice (lru.begin(), lru, varobj->lru);
+}
+
+// release the value of a varobj
+void
+VarobjTable::release (VAROBJ *varobj)
+{
+	if (varobj->value.IsValid()) {
+		varobj->value = SBValue();
+		--live;
+	}
+}
+
+// delete a varobj and its children. return the number of deleted varobjs
+int
+VarobjTable::erase (VAROBJ *varobj)
+{
+	int deleted = 1;
+	std::map<int, VAROBJ *> children = varobj->children;
+	for (auto &entry : children)
+		deleted += erase (entry.second);
+	if (varobj->parent != NULL) {
+		std::map<int, VAROBJ *> &siblings = varobj->parent->children;
+		auto it = siblings.find (varobj->index);
+		if (it!=siblings.end() && it->second==varobj)
+			siblings.erase (it);
+		--varobj->parent->refcount;
+	}
+	release (varobj);
+	listedchildren.erase (varobj);
+	evictedindexes.erase (varobj->name);
+	std::string prefix = varobj->name + ".";			// evicted children of the varobj are gone too
+	auto evicted = evictedindexes.lower_bound (prefix);
+	while (evicted!=evictedindexes.end() && evicted->first.compare (0, prefix.size(), prefix)==0)
+		evicted = evictedindexes.erase (evicted);
+	lru.erase (varobj->lru);
+	varobjs.erase (varobj->name);
+	delete varobj;
+	return deleted;
+}
+
+// evict the least recently used varobjs which are out of scope and not referenced by children
+// until the budget is met. the most recently used is kept
+void
+VarobjTable::evict ()
+{
+	logprintf (LOG_TRACE, "VarobjTable::evict (%d, %d)\n", live, limits.varobjs_max);
+	std::list<VAROBJ *>::iterator it = lru.end();
+	while (live>limits.varobjs_max && it!=lru.begin()) {
+		VAROBJ *varobj = *--it;
+		if (it == lru.begin())
+			break;
+		if (varobj->refcount>1 || !varobj->value.IsValid()
+				|| SBCALL (SBValue_IsInScope, varobj->value.IsInScope()))
+			continue;
+		logprintf (LOG_DEBUG, "VarobjTable::evict: %s\n", varobj->name.c_str());
+		++evictions;
+		if (varobj->parent != NULL) {
+			++it;						// the iterator on the next varobj stays valid
+			int index = varobj->index;
+			std::string name = varobj->name;
+			erase (varobj);
+			evictedindexes[name] = index;		// to register it again without scanning its siblings
+		}
+		else
+			release (varobj);
+	}
+}
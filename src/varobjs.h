@@ -0,0 +1,134 @@
+
+#ifndef VAROBJS_H
+#define VAROBJS_H
+
+#include <lldb/API/LLDB.h>
+using namespace lldb;
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "format.h"
+#include "stringb.h"
+
+/*
+ * Varobjs of the IDE
+ * -var-create creates a root named varN or named by the IDE. A root on a local or an
+ * argument is bound to the frame where it was created, and is out of scope once this frame
+ * is gone. A floating root (@) is evaluated again in the selected frame at each stop.
+ * -var-list-children registers its children
+ * named parent.child. A listed child is a handle on its parent and its index, with its
+ * name, type and number of children, read once per stop. Its value is used when the IDE
+ * first uses it, as listed at this stop or fetched again from its parent.
+ * A varobj is referenced once by the IDE and once by each child in the table.
+ * -var-delete removes a varobj and its children. A frozen varobj and its children are
+ * updated only by -var-update of the varobj itself. -var-set-update-range limits the
+ * children of a varobj which are updated to a window.
+ * When more than limits.varobjs_max varobjs hold a value, the least recently used
+ * ones which are out of scope and have no children in the table are evicted:
+ * children are removed, roots release their value and are evaluated again when used,
+ * in their frame if bound.
+ * Each varobj keeps a snapshot of its state at the previous update. -var-update reports
+ * the varobjs whose snapshot changed, without relying on SBValue::GetValueDidChange.
+ * -var-set-format formats again the raw bytes of the snapshot taken at the current stop.
+ */
+
+// state of a varobj at the previous update
+typedef struct {
+	bool inscope;
+	bool simple;						// not an aggregate nor an array
+	unsigned long long hash;			// raw bytes of simple values
+	std::string bytes;					// of simple values up to 8 bytes, little endian
+	int generation;						// stop of the process when taken
+	std::string type;
+	std::string value;					// formatted value
+	std::string natural;				// formatted value in natural format if known
+} VARSNAPSHOT;
+
+// snapshots taken during an update of all varobjs, by address and type
+// varobjs on the same object share them, so the object is read once
+typedef std::map<std::pair<unsigned long long, std::string>, VARSNAPSHOT> SNAPSHOTCACHE;
+
+extern const Format formatcodes[];	// LLDB formats by ValueFormat
+
+typedef struct VAROBJ {
+	int id;								// creation order
+	std::string name;					// var1, var1.a
+	std::string expression;				// expression of a root, name of a child
+	SBValue value;						// invalid if evicted or lazy
+	struct VAROBJ *parent;				// NULL for a root
+	int index;							// in the parent. -1 for a root
+	bool lazy;							// child whose value is not fetched yet
+	SBValue listedvalue;				// of a lazy child listed at this stop
+	int listed;							// stop of the process at the last listing of a child
+	std::string type;					// of a child at its last listing
+	int numchildren;
+	bool frozen;						// not updated by a parent nor by *
+	int updatefrom;						// children updated. all if negative
+	int updateto;
+	ValueFormat format;					// of -var-set-format
+	int threadindexid;					// frame of the root at creation
+	int frameid;
+	bool floating;						// root evaluated in the selected frame
+	unsigned long long cfa;				// frame of a bound root, or LLDB_INVALID_ADDRESS if not bound
+	std::string function;
+	int generation;						// stop of the process when a floating root was evaluated
+	std::map<int, struct VAROBJ *> children;	// children in the table by index
+	int refcount;						// IDE and children references
+	VARSNAPSHOT snapshot;
+	std::list<struct VAROBJ *>::iterator lru;
+} VAROBJ;
+
+class VarobjTable {
+private:
+	std::map<std::string, VAROBJ *> varobjs;
+	std::list<VAROBJ *> lru;			// most recently used first
+	int nextid;							// of the next root name
+	int nextorder;						// of the next varobj
+	int live;							// varobjs holding a value
+	int evictions;
+	int framesgeneration;				// stop when frames were checked
+	int listedgeneration;				// stop of the lazy children holding their listed value
+	std::set<VAROBJ *> listedchildren;
+	std::map<std::string, int> evictedindexes;	// index of evicted children by name
+	std::map<std::pair<int, unsigned long long>, bool> frames;	// alive frames by thread and cfa
+	VAROBJ *insert (const std::string &name, const char *expression, SBValue value, VAROBJ *parent, int index);
+	VAROBJ *addchild (VAROBJ *parent, int index, SBValue child, bool lazy);
+	VAROBJ *resolve (const std::string &name, SBFrame frame);
+	VAROBJ *resolvechild (VAROBJ *varobj, const std::string &name, const std::string &childname);
+	void    touch (VAROBJ *varobj);
+	void    release (VAROBJ *varobj);
+	int     erase (VAROBJ *varobj);
+	void    evict ();
+	void    snapshot (VAROBJ *varobj, SNAPSHOTCACHE *cache=NULL);
+	bool    framealive (VAROBJ *varobj);
+	SBFrame boundframe (VAROBJ *varobj, SBProcess process);
+	void    rebind (VAROBJ *varobj, SBFrame frame);
+	void    refetch (VAROBJ *varobj);
+	void    setvalue (VAROBJ *varobj, SBValue value);
+	void    droplisted ();
+	VarobjTable (const VarobjTable &);
+	VarobjTable &operator= (const VarobjTable &);
+public:
+	VarobjTable ();
+	~VarobjTable ();
+	VAROBJ *create (const char *name, const char *expression, SBValue value, SBFrame frame, bool floating);
+	VAROBJ *child (VAROBJ *parent, int index);
+	void    materialize (VAROBJ *varobj);
+	VAROBJ *find (const char *name, SBFrame frame);
+	int     remove (const char *name, bool childrenonly);
+	bool    setfrozen (const char *name, bool frozen);
+	bool    setupdaterange (const char *name, int from, int to);
+	char   *setformat (StringB &vardescB, VAROBJ *varobj, ValueFormat format);
+	char   *update (StringB &changedescB, VAROBJ *varobj, int printvalues, bool &separatorvisible, SNAPSHOTCACHE *cache=NULL);
+	char   *updateall (StringB &changedescB, SBFrame frame, int printvalues);
+	void    clear ();
+	int     size ();
+	int     livesize ();
+	int     evicted ();
+};
+
+#endif // VAROBJS_H
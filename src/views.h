@@ -0,0 +1,94 @@
+
+#ifndef VIEWS_H
+#define VIEWS_H
+
+#include <memory>
+
+class StringB;
+
+/*
+ * Views of values, frames, threads and processes
+ * The formatting functions of format.cpp only see the debugged program through these interfaces.
+ * sbviews.cpp implements them on top of the LLDB SB API, and bench/synthetic.cpp with an
+ * in-memory model, so formatting can be tested and measured without LLDB nor an inferior.
+ */
+
+// type flags. as returned by SBType::IsPointerType... and SBType::GetTypeClass
+#define VIEW_POINTER     0x1
+#define VIEW_REFERENCE   0x2
+#define VIEW_ARRAY       0x4
+#define VIEW_AGGREGATE   0x8		// class, struct or union
+
+class ValueView;
+class ValueListView;
+class FrameView;
+class ThreadView;
+typedef std::unique_ptr<ValueView>     ValueRef;
+typedef std::unique_ptr<ValueListView> ValueListRef;
+typedef std::unique_ptr<FrameView>     FrameRef;
+typedef std::unique_ptr<ThreadView>    ThreadRef;
+
+class ValueView {
+public:
+	virtual ~ValueView () {}
+	virtual bool        isvalid () = 0;
+	virtual bool        isfailed () = 0;					// has an error
+	virtual const char *errorstring () = 0;
+	virtual const char *name () = 0;						// may be NULL
+	virtual const char *value () = 0;						// NULL for aggregates
+	virtual const char *summary () = 0;						// may be NULL
+	virtual const char *displaytypename () = 0;
+	virtual int         typeflags () = 0;					// VIEW_xxx
+	virtual int         numchildren () = 0;
+	virtual ValueRef    childat (int index, bool dynamic=false) = 0;	// dynamic: dynamic type by the current policy
+	virtual void        expressionpath (StringB &pathB) = 0;	// append the expression path
+	virtual bool        isinscope () = 0;
+	virtual bool        isargument () = 0;						// argument of its function
+	virtual unsigned long long valueasunsigned () = 0;
+	virtual unsigned long long loadaddress () = 0;
+	virtual void        setprefersynthetic () = 0;			// prefer synthetic children (pretty printers)
+};
+
+class ValueListView {
+public:
+	virtual ~ValueListView () {}
+	virtual int         size () = 0;
+	virtual ValueRef    at (int index) = 0;
+};
+
+class FrameView {
+public:
+	virtual ~FrameView () {}
+	virtual bool        isvalid () = 0;
+	virtual int         frameid () = 0;
+	virtual unsigned long long pc () = 0;
+	virtual bool        hasfunction () = 0;					// has debug information
+	virtual const char *functionname () = 0;
+	virtual const char *filename () = 0;
+	virtual const char *filedirectory () = 0;
+	virtual int         line () = 0;
+	virtual const char *modulefilename () = 0;
+	virtual ValueListRef arguments () = 0;
+};
+
+class ThreadView {
+public:
+	virtual ~ThreadView () {}
+	virtual bool        isvalid () = 0;
+	virtual int         threadid () = 0;
+	virtual int         indexid () = 0;
+	virtual int         numframes () = 0;
+	virtual FrameRef    frameat (int index) = 0;
+};
+
+class ProcessView {
+public:
+	virtual ~ProcessView () {}
+	virtual bool        isvalid () = 0;
+	virtual int         pid () = 0;
+	virtual bool        isstopped () = 0;
+	virtual int         numthreads () = 0;
+	virtual ThreadRef   threadat (int index) = 0;
+};
+
+#endif // VIEWS_H
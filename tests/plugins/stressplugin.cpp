@@ -0,0 +1,10 @@
+// shared library loaded many times by stress 6 (tests/src/stress.cpp)
+
+static int calls = 0;
+
+extern "C" int
+stressplugin (int index)
+{
+	++calls;
+	return index + calls;
+}
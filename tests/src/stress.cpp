@@ -0,0 +1,248 @@
+// stress programs for LLDBMI2 benchmarks
+// stress <test> [size]. default sizes are production scale. tests/scripts/stress/*.txt drive them
+
+// avoid adding or removing lines or -break-insert statements must be ajusted in tests/scripts/stress
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/////////////////////////////
+
+pthread_mutex_t blockmutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t blockcond = PTHREAD_COND_INITIALIZER;
+int startedthreads = 0;
+
+// threads block at different depths in different functions
+int blockA (int depth, int index);
+int blockB (int depth, int index);
+
+int
+block (int index)
+{
+	pthread_mutex_lock (&blockmutex);
+	++startedthreads;
+	pthread_cond_broadcast (&blockcond);
+	while (true)
+		pthread_cond_wait (&blockcond, &blockmutex);		// threads never resume
+	return index;
+}
+
+int
+blockA (int depth, int index)
+{
+	volatile int local = index;
+	if (depth <= 0)
+		return block (local);
+	return (index&1)? blockB (depth-1, index): blockA (depth-1, index);
+}
+
+int
+blockB (int depth, int index)
+{
+	volatile int local = index;
+	if (depth <= 0)
+		return block (local);
+	return (index&2)? blockA (depth-1, index): blockB (depth-1, index);
+}
+
+void *
+blockthread (void *arg)
+{
+	long index = (long)arg;
+	blockA (index%16, (int)index);
+	return NULL;
+}
+
+int test_THREADS (int count)
+{
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr, 64*1024);
+	int created = 0;
+	for (long ithread=0; ithread<count; ithread++) {
+		pthread_t tid;
+		if (pthread_create (&tid, &attr, blockthread, (void *)ithread) != 0)
+			break;
+		++created;
+	}
+	pthread_mutex_lock (&blockmutex);
+	while (startedthreads < created)
+		pthread_cond_wait (&blockcond, &blockmutex);
+	pthread_mutex_unlock (&blockmutex);
+	printf ("threads %d\n", created);
+	return 0;										// breakpoint 1 in stress/threads.txt
+}
+
+/////////////////////////////
+
+int
+recurse (int depth)
+{
+	volatile int local = depth;
+	if (depth <= 0)
+		return 0;									// breakpoint 1 in stress/recursion.txt
+	return recurse (depth-1) + local;
+}
+
+void *
+recursethread (void *arg)
+{
+	recurse ((int)(long)arg);
+	return NULL;
+}
+
+int test_RECURSION (int depth)
+{
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr, 512*1024*1024);	// deep recursion needs more than the main stack
+	pthread_t tid;
+	if (pthread_create (&tid, &attr, recursethread, (void *)(long)depth) != 0)
+		return 1;
+	pthread_join (tid, NULL);
+	return 0;
+}
+
+/////////////////////////////
+
+typedef struct {	// can view structs only if typedef in dwarf
+	int id;
+	double value;
+	const char *label;
+} Struct;
+
+int test_CONTAINERS (int count)
+{
+	std::vector<std::map<std::string, Struct> > table (count);
+	for (int ientry=0; ientry<count; ientry++) {
+		char key[32];
+		snprintf (key, sizeof(key), "key%d", ientry);
+		Struct s = { ientry, ientry*0.5, "entry" };
+		table[ientry][key] = s;
+		if (ientry%100 == 0)						// some larger maps
+			for (int iextra=0; iextra<10; iextra++) {
+				snprintf (key, sizeof(key), "extra%d", iextra);
+				table[ientry][key] = s;
+			}
+	}
+	printf ("containers %zu\n", table.size());
+	return 0;										// breakpoint 1 in stress/containers.txt
+}
+
+/////////////////////////////
+
+int test_HEAP (int megabytes)
+{
+	size_t size = (size_t)megabytes*1024*1024;
+	char *buffer = (char *)malloc (size);
+	if (buffer == NULL)
+		return 1;
+	for (size_t offset=0; offset<size; offset+=4096)	// commit the pages
+		buffer[offset] = (char)(offset>>12);
+	memcpy (buffer, "heap buffer start", 18);
+	printf ("heap %d MB at %p\n", megabytes, buffer);
+	free (buffer);									// breakpoint 1 in stress/heap.txt
+	return 0;
+}
+
+/////////////////////////////
+
+// one location per instance for a breakpoint on the line of located
+template <int N>
+int located ()
+{
+	volatile int value = N;
+	return value;									// breakpoint 1 in stress/templates.txt
+}
+
+template <int... N>
+int locateall (std::integer_sequence<int, N...>)
+{
+	int sum = 0;
+	int values[] = { (sum += located<N>())... };
+	return values[0];
+}
+
+int test_TEMPLATES ()
+{
+	return locateall (std::make_integer_sequence<int, 2000>()) > 0? 0: 1;
+}
+
+/////////////////////////////
+
+// load count copies of libstressplugin.so found next to the executable
+int test_LIBRARIES (const char *program, int count)
+{
+	char directory[PATH_MAX], plugin[PATH_MAX+32], copy[PATH_MAX];
+	strncpy (directory, program, sizeof(directory)-1);
+	directory[sizeof(directory)-1] = '\0';
+	char *slash = strrchr (directory, '/');
+	if (slash != NULL)
+		*slash = '\0';
+	else
+		strcpy (directory, ".");
+	snprintf (plugin, sizeof(plugin), "%s/libstressplugin.so", directory);
+	FILE *source = fopen (plugin, "rb");
+	if (source == NULL) {
+		printf ("can not open %s\n", plugin);
+		return 1;
+	}
+	std::vector<char> image;
+	char buffer[8192];
+	size_t bytes;
+	while ((bytes = fread (buffer, 1, sizeof(buffer), source)) > 0)
+		image.insert (image.end(), buffer, buffer+bytes);
+	fclose (source);
+	int loaded = 0, sum = 0;
+	for (int ilibrary=0; ilibrary<count; ilibrary++) {
+		snprintf (copy, sizeof(copy), "/tmp/stressplugin-%d-%d.so", (int)getpid(), ilibrary);
+		FILE *target = fopen (copy, "wb");
+		if (target == NULL)
+			break;
+		fwrite (image.data(), 1, image.size(), target);
+		fclose (target);
+		void *handle = dlopen (copy, RTLD_NOW|RTLD_LOCAL);
+		unlink (copy);
+		if (handle == NULL)
+			continue;
+		int (*pluginfunction)(int) = (int (*)(int))dlsym (handle, "stressplugin");
+		if (pluginfunction != NULL)
+			sum += pluginfunction (ilibrary);
+		++loaded;
+	}
+	printf ("libraries %d, sum %d\n", loaded, sum);
+	return 0;										// breakpoint 1 in stress/libraries.txt
+}
+
+/////////////////////////////
+
+// execute a specific stress test
+int
+main (int argc, char **argv)
+{
+	int test = 0, size = 0;
+	if (argc>1)
+		sscanf (argv[1], "%d", &test);
+	if (argc>2)
+		sscanf (argv[2], "%d", &size);
+	printf ("stress %d\n", test);
+
+	switch (test) {
+	case 1:		return test_THREADS (size>0? size: 10000);
+	case 2:		return test_RECURSION (size>0? size: 100000);
+	case 3:		return test_CONTAINERS (size>0? size: 1000000);
+	case 4:		return test_HEAP (size>0? size: 1024);
+	case 5:		return test_TEMPLATES ();
+	case 6:		return test_LIBRARIES (argv[0], size>0? size: 300);
+	}
+	return 0;
+}
@@ -390,6 +390,23 @@ int test_LONG_INHERITANCE ()
 
 ///////////////////////////////
 
+typedef struct {
+	unsigned char low : 3;
+	unsigned char high : 5;
+	int sign : 4;
+} BITS;
+
+int test_BITFIELD ()
+{
+	BITS bits;
+	bits.low = 5;
+	bits.high = 17;
+	bits.sign = -3;
+	return bits.low + bits.high;					// breakpoint 1 in testcommands_BITFIELD
+}
+
+///////////////////////////////
+
 // execute a specific test sequence
 // MUST HAVE A CORRESPONDING TEST SEQUENCE IN lldbmi2/test.cpp
 
@@ -418,6 +435,7 @@ main (int argc, char **argv)
 	case 14:	return test_BASE ();		// OTHER
     case 15:    return test_BIG_CLASS ();
     case 16:    return test_LONG_INHERITANCE ();
+	case 17:	return test_BITFIELD ();
 	}
 	return 0;
 }
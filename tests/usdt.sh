@@ -0,0 +1,17 @@
+#!/bin/sh
+# check that the USDT probes of src/probes.h are present in lldbmi2
+# usage: usdt.sh path/to/lldbmi2
+
+binary=${1:-lldbmi2}
+notes=`readelf -n "$binary"` || exit 1
+status=0
+for probe in command_begin command_end stop_event_received stopped_emitted \
+		inferior_output_forwarded varobj_created varobj_updated; do
+	if echo "$notes" | grep -q "Name: $probe\$"; then
+		echo "found lldbmi2:$probe"
+	else
+		echo "missing lldbmi2:$probe"
+		status=1
+	fi
+done
+exit $status